@@ -0,0 +1,248 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+#include "bit_group_field.h"
+#include "bit_kernel.h"
+
+namespace pdl {
+
+bit_group_field::bit_group_field(
+    const bit_group_item * items, uint32_t itemCount)
+{
+    mItems = items;
+    mItemCount = 0;
+    mGroupSize = 0;
+    uint32_t groupSize = 0;
+    uint32_t i = 0;
+    for (; items && i < itemCount; ++i) {
+        if ( 0 == items[i].mSize || items[i].mSize > 64 - groupSize )
+            break; // a 0-size item, or the items beyond 64 bits.
+        groupSize += items[i].mSize;
+    }
+    if ( !items || 0 == itemCount || itemCount > MAX_ITEM_COUNT || \
+         i < itemCount )
+    {
+        PDL_THROW( std::invalid_argument(
+            "bit_group_field::bit_group_field() invalid argument!"
+        ) );
+        return;
+    }
+    // The 1st. item is the MSB of the group for the MSB-first bits, or the
+    // LSB for the LSB-first bits.
+    uint32_t offset = 0;
+    for (i = 0; i < itemCount; ++i) {
+        uint32_t size = items[i].mSize;
+        uint64_t mask = ~uint64_t(0) >> (64 - size);
+        mMasks[0][i] = mask << (groupSize - offset - size);
+        mMasks[1][i] = mask << offset;
+        offset += size;
+    }
+    mItemCount = itemCount;
+    mGroupSize = groupSize;
+}
+
+uint32_t bit_group_field::FindItem(const char * name) const {
+    uint32_t i = 0;
+    for (; name && i < mItemCount; ++i) {
+        if ( 0 == strcmp(name, mItems[i].mName) )
+            break;
+    }
+    return name? i: mItemCount;
+}
+
+uint32_t bit_group_field::DecodeGroup(
+    bit_ref bitRef, uint64_t * out_vals) const
+{
+    unchecked_bit_ref bits;
+    if ( out_vals && mItemCount && bitRef.Unchecked(mGroupSize, &bits) ) {
+        bool lsbFirst = bitRef.IsLsbFirst();
+        bit_kernel::ExtractBits(
+            bits.ReadUInt(mGroupSize, lsbFirst),
+            mMasks[lsbFirst],
+            mItemCount,
+            out_vals
+        );
+        return mItemCount;
+    }
+    return 0;
+}
+
+bool bit_group_field::EncodeGroup(bit_ref bitRef, const uint64_t * vals) const {
+    unchecked_bit_ref bits;
+    if ( vals && mItemCount && bitRef.IsWritable() && \
+         bitRef.Unchecked(mGroupSize, &bits) )
+    {
+        bool lsbFirst = bitRef.IsLsbFirst();
+        bits.WriteUInt(
+            mGroupSize,
+            bit_kernel::DepositBits(vals, mMasks[lsbFirst], mItemCount),
+            lsbFirst
+        );
+        return true;
+    }
+    return false;
+}
+
+bool bit_group_field::DecodeField(bit_ref bitRef, value_obj * out_val) const {
+    unchecked_bit_ref bits;
+    if ( out_val && mItemCount && bitRef.Unchecked(mGroupSize, &bits) ) {
+        out_val->Reset();
+        val_itf_selector<int64_val>::GetInterface(out_val)->Val() = \
+            bits.ReadUInt( mGroupSize, bitRef.IsLsbFirst() );
+        return true;
+    }
+    return false;
+}
+
+bool bit_group_field::EncodeField(
+    bit_ref bitRef, const value_obj * val) const
+{
+    const int64_val * itf = val_itf_selector<int64_val>::GetInterface(val);
+    unchecked_bit_ref bits;
+    if ( itf && mItemCount && bitRef.IsWritable() && \
+         bitRef.Unchecked(mGroupSize, &bits) )
+    {
+        bits.WriteUInt( mGroupSize, itf->Val(), bitRef.IsLsbFirst() );
+        return true;
+    }
+    return false;
+}
+
+} // namespace pdl
+
+#ifdef BIT_GROUP_FIELD_UT
+#include <iostream>
+
+using namespace pdl;
+
+// The _flags of the demo protocol in README, and a wider group.
+static const bit_group_item FLAGS_ITEMS[] = {
+    {"_flag1", 1}, {"_flag2", 1}, {"_flag3", 2}, {"_flag4", 4}
+};
+static const bit_group_item WIDE_ITEMS[] = {
+    {"a", 3}, {"b", 17}, {"c", 1}, {"d", 9}, {"e", 30}
+};
+
+class flags_test_field: public bit_group_field {
+public:
+    flags_test_field(): bit_group_field(FLAGS_ITEMS, 4) {
+    }
+    virtual const char * FieldName() const {
+        return "_flags";
+    }
+};
+
+class wide_test_field: public bit_group_field {
+public:
+    wide_test_field(): bit_group_field(WIDE_ITEMS, 5) {
+    }
+    virtual const char * FieldName() const {
+        return "wide";
+    }
+};
+
+class bad_test_field: public bit_group_field {
+public:
+    bad_test_field(const bit_group_item * items, uint32_t itemCount)
+        : bit_group_field(items, itemCount)
+    {}
+    virtual const char * FieldName() const {
+        return "bad";
+    }
+};
+
+static bool isRejected(const bit_group_item * items, uint32_t itemCount) {
+#ifdef DISABLE_RTTI
+    return 0 == bad_test_field(items, itemCount).ItemCount();
+#else
+    try {
+        bad_test_field field(items, itemCount);
+    } catch (const std::invalid_argument &) {
+        return true;
+    }
+    return false;
+#endif
+}
+
+// Compares the items with the ones read one by one, and then writes them back.
+static bool testGroup(const bit_group_field & field, buf_val * buf) {
+    uint64_t vals[bit_group_field::MAX_ITEM_COUNT];
+    for (bit_size_t offset = 0; offset < 24; ++offset) {
+        for (int lsbFirst = 0; lsbFirst < 2; ++lsbFirst) {
+            bit_ref bitRef(buf, offset, lsbFirst != 0);
+            uint32_t n = field.DecodeGroup(bitRef, vals);
+            bit_ref itemRef(bitRef);
+            for (uint32_t i = 0; i < n; ++i) {
+                uint32_t size = field.Items()[i].mSize;
+                if ( itemRef.ReadUInt(size, lsbFirst != 0) != vals[i] ) {
+                    std::cout << field.FieldName() << " failed: @" << \
+                        offset << ", " << field.Items()[i].mName << std::endl;
+                    return false;
+                }
+                itemRef += size;
+            }
+            std::vector<uint8_t> orig(
+                static_cast<uint8_t *>( buf->Buf() ),
+                static_cast<uint8_t *>( buf->Buf() ) + buf->Size()
+            );
+            value_obj val;
+            if ( n != field.ItemCount() || \
+                !field.DecodeField(bitRef, &val) || \
+                !field.EncodeGroup(bitRef, vals) || \
+                memcmp( &(orig[0]), buf->Buf(), buf->Size() ) )
+            {
+                std::cout << field.FieldName() << " failed to encode: @" << \
+                    offset << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int main() {
+    buf_val buf;
+    buf.Resize(16);
+    uint8_t * data = static_cast<uint8_t *>( buf.Buf() );
+    for (uint32_t i = 0; i < 16; ++i)
+        data[i] = uint8_t(i * 0x3b + 0x51);
+    flags_test_field flagsField;
+    wide_test_field wideField;
+    bool ok = testGroup(flagsField, &buf) && testGroup(wideField, &buf) && \
+        flagsField.FindItem("_flag3") == 2 && flagsField.FindItem("x") == 4;
+
+    // The items beyond 64 bits, or a 0-size one.
+    const bit_group_item WIDE_BAD_ITEMS[] = {{"a", 40}, {"b", 40}};
+    const bit_group_item ZERO_BAD_ITEMS[] = {{"a", 4}, {"b", 0}};
+    ok = ok && isRejected(WIDE_BAD_ITEMS, 2) && \
+        isRejected(ZERO_BAD_ITEMS, 2) && !isRejected(WIDE_ITEMS, 5);
+
+    // 0x51: _flag1 0, _flag2 1, _flag3 01, _flag4 0001.
+    uint64_t vals[4];
+    ok = ok && flagsField.DecodeGroup(bit_ref(&buf, 0), vals) == 4 && \
+        vals[0] == 0 && vals[1] == 1 && vals[2] == 1 && vals[3] == 1;
+
+    std::cout << \
+        (ok? "bit_group_field test passed.": "bit_group_field test failed!") \
+        << std::endl;
+    return ok? 0: 1;
+}
+#endif // BIT_GROUP_FIELD_UT
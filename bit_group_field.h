@@ -0,0 +1,111 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+#ifndef _BIT_GROUP_FIELD_H_
+#define _BIT_GROUP_FIELD_H_
+
+#ifndef __cplusplus
+#error The module is NOT compatible with C codes.
+#endif
+
+#include "field_des.h"
+
+namespace pdl {
+
+struct bit_group_item {
+    const char * mName;
+    uint32_t mSize; // in bit.
+};
+
+// The leaf field of the packed sub-byte fields (e.g. a group of flags), which
+// is loaded once and split into all the items by PEXT (or the shift & mask),
+// instead of a leaf field (and a field_info) per item. The items are from the
+// 1st. bit of the group, and the total size is 1 ~ 64 bits. The derived class
+// should implement FieldName().
+// The whole group is decoded/encoded as an int64_val by DecodeField() and
+// EncodeField(), and the callback gets the items by DecodeGroup().
+class bit_group_field: public leaf_field_des {
+public:
+    enum item_count_value {
+        MAX_ITEM_COUNT = 64
+    };
+
+private:
+    const bit_group_item * mItems;
+    uint32_t mItemCount;
+    uint32_t mGroupSize;
+    uint64_t mMasks[2][MAX_ITEM_COUNT]; // for MSB-first & LSB-first bits.
+
+public:
+    bit_group_field(const bit_group_item * items, uint32_t itemCount);
+
+    uint32_t ItemCount() const {
+        return mItemCount;
+    }
+    const bit_group_item * Items() const {
+        return mItems;
+    }
+    // Returns the index of the item, or ItemCount() if not found.
+    uint32_t FindItem(const char * name) const;
+
+    // Outputs all the items, returns the count of items or 0 if the group is
+    // beyond the buffer.
+    uint32_t DecodeGroup(bit_ref bitRef, uint64_t * out_vals) const;
+    uint32_t DecodeGroup(
+        const field_info & fieldInfo,
+        const buf_val * buf,
+        uint64_t * out_vals) const
+    {
+        return DecodeGroup(fieldInfo.RefBits(buf), out_vals);
+    }
+    // The values are truncated to the sizes of items.
+    bool EncodeGroup(bit_ref bitRef, const uint64_t * vals) const;
+
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 1;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return mGroupSize;
+    }
+    virtual bit_size_t ConstFieldSize() const {
+        return mGroupSize;
+    }
+    virtual bool DecodeField(bit_ref bitRef, value_obj * out_val) const;
+    virtual bool EncodeField(bit_ref bitRef, const value_obj * val) const;
+    // The group is read in the byte order of its bit order.
+    virtual bool IsRawUInt() const {
+        uint32_t fieldOrder = FieldOrder();
+        return (0 != (fieldOrder & FIELD_ORDER_LSB_FIRST)) == \
+            (0 != (fieldOrder & FIELD_ORDER_LITTLE_ENDIAN));
+    }
+};
+
+} // namespace pdl
+
+#endif // _BIT_GROUP_FIELD_H_
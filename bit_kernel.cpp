@@ -0,0 +1,903 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "bit_kernel.h"
+
+#if !defined(DISABLE_SIMD) && defined(__GNUC__) && \
+    ( defined(__x86_64__) || defined(__i386__) )
+#  define BIT_KERNEL_X86
+#  include <immintrin.h>
+#  define BIT_KERNEL_TARGET(ISA) __attribute__(( target(ISA) ))
+#endif
+
+using namespace pdl;
+
+typedef void (* shift_blocks_kernel)(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t shift
+);
+typedef void (* byte_swap_blocks_kernel)(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t itemSize
+);
+typedef size_t (* find_bytes_kernel)(
+    const uint8_t * data, size_t size, const uint8_t * pattern, size_t m
+);
+// 'crc' is the CRC register, i.e. the inverted result.
+typedef uint32_t (* crc32_kernel)(
+    uint32_t crc, const uint8_t * data, size_t size
+);
+typedef void (* extract_bits_kernel)(
+    uint64_t word, const uint64_t * masks, uint32_t count, uint64_t * out_vals
+);
+typedef uint64_t (* deposit_bits_kernel)(
+    const uint64_t * vals, const uint64_t * masks, uint32_t count
+);
+
+enum crc32_poly {
+    CRC32_IEEE,
+    CRC32_CASTAGNOLI
+};
+static const uint32_t CRC32_REFLECTED_POLY[] = {0xedb88320, 0x82f63b78};
+// The slicing-by-8 tables, which are built by gKernelInitializer (or by the
+// resolvers of CRC kernels if they are called before it):
+//   table[k][i] is the CRC of the byte 'i' followed by 'k' zero bytes.
+static uint32_t gCrc32Table[2][8][256];
+
+static void buildCrc32Table(int poly) {
+    uint32_t (* table)[256] = gCrc32Table[poly];
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (uint32_t j = 0; j < 8; ++j)
+            crc = (crc >> 1) ^ ( (crc & 1)? CRC32_REFLECTED_POLY[poly]: 0 );
+        table[0][i] = crc;
+    }
+    for (uint32_t k = 1; k < 8; ++k) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = table[k - 1][i];
+            table[k][i] = (crc >> 8) ^ table[0][crc & 0xff];
+        }
+    }
+}
+
+template <int POLY>
+static uint32_t crc32Scalar(uint32_t crc, const uint8_t * data, size_t size) {
+    const uint32_t (* table)[256] = gCrc32Table[POLY];
+    for (; size >= 8; size -= 8, data += 8) {
+        uint32_t lo = crc ^ ( uint32_t(data[0]) | ( uint32_t(data[1]) << 8 ) | \
+            ( uint32_t(data[2]) << 16 ) | ( uint32_t(data[3]) << 24 ) );
+        crc = table[7][lo & 0xff] ^ table[6][(lo >> 8) & 0xff] ^ \
+            table[5][(lo >> 16) & 0xff] ^ table[4][lo >> 24] ^ \
+            table[3][data[4]] ^ table[2][data[5]] ^ \
+            table[1][data[6]] ^ table[0][data[7]];
+    }
+    for (; size; --size, ++data)
+        crc = (crc >> 8) ^ table[0][(crc ^ *data) & 0xff];
+    return crc;
+}
+
+template <bool LSB_FIRST>
+static void shiftBlocksScalar(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t shift)
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        if (LSB_FIRST) {
+            bit_kernel::StoreLE64(
+                dst + i,
+                ( bit_kernel::LoadLE64(src + i) >> shift ) | \
+                    ( uint64_t(src[i + 8]) << (64 - shift) )
+            );
+        } else {
+            bit_kernel::StoreBE64(
+                dst + i,
+                ( bit_kernel::LoadBE64(src + i) << shift ) | \
+                    ( src[i + 8] >> (8 - shift) )
+            );
+        }
+    }
+    for (; i < n; ++i) {
+        dst[i] = LSB_FIRST \
+            ? uint8_t( (src[i] >> shift) | ( src[i + 1] << (8 - shift) ) ) \
+            : uint8_t( (src[i] << shift) | ( src[i + 1] >> (8 - shift) ) );
+    }
+}
+
+static void byteSwapBlocksScalar(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t itemSize)
+{
+    for (size_t i = 0; i < n; ++i, src += itemSize, dst += itemSize) {
+        uint64_t item = 0;
+        for (uint32_t j = 0; j < itemSize; ++j)
+            item = (item << 8) | src[j];
+        for (uint32_t j = 0; j < itemSize; ++j, item >>= 8)
+            dst[j] = uint8_t(item);
+    }
+}
+
+// The caller makes sure 'm' is 1 ~ 'size'.
+static size_t findBytesScalar(
+    const uint8_t * data, size_t size, const uint8_t * pattern, size_t m)
+{
+    if (size < m) // the tail of the SIMD versions may be shorter.
+        return size;
+    const uint8_t * p = data;
+    const uint8_t * last = data + size - m; // the last candidate.
+    while (p <= last) {
+        p = static_cast<const uint8_t *>(
+            memchr(p, pattern[0], last - p + 1)
+        );
+        if (!p)
+            break;
+        if ( 0 == memcmp(p, pattern, m) )
+            return p - data;
+        ++p;
+    }
+    return size;
+}
+
+// A contiguous mask is done by one shift (the count of its trailing zero
+// bits), and the other ones bit by bit from the lowest bit like PEXT/PDEP.
+static uint64_t extractBitsScalar(uint64_t word, uint64_t mask) {
+    uint64_t lowBit = mask & (0 - mask);
+    if ( 0 == ( (mask + lowBit) & mask ) ) {
+        return lowBit? (word & mask) >> \
+            ( 63 - bit_kernel::CountLeadingZeros64(lowBit) ): 0;
+    }
+    uint64_t val = 0;
+    for (uint64_t bit = 1; mask; bit <<= 1, mask ^= lowBit) {
+        lowBit = mask & (0 - mask);
+        if (word & lowBit)
+            val |= bit;
+    }
+    return val;
+}
+
+static uint64_t depositBitsScalar(uint64_t val, uint64_t mask) {
+    uint64_t lowBit = mask & (0 - mask);
+    if ( 0 == ( (mask + lowBit) & mask ) ) {
+        return lowBit? ( val << \
+            ( 63 - bit_kernel::CountLeadingZeros64(lowBit) ) ) & mask: 0;
+    }
+    uint64_t word = 0;
+    for (uint64_t bit = 1; mask; bit <<= 1, mask ^= lowBit) {
+        lowBit = mask & (0 - mask);
+        if (val & bit)
+            word |= lowBit;
+    }
+    return word;
+}
+
+static void extractBitsScalar(
+    uint64_t word, const uint64_t * masks, uint32_t count, uint64_t * out_vals)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        out_vals[i] = extractBitsScalar(word, masks[i]);
+}
+
+static uint64_t depositBitsScalar(
+    const uint64_t * vals, const uint64_t * masks, uint32_t count)
+{
+    uint64_t word = 0;
+    for (uint32_t i = 0; i < count; ++i)
+        word |= depositBitsScalar(vals[i], masks[i]);
+    return word;
+}
+
+#ifdef BIT_KERNEL_X86
+
+// There is no byte-shift instruction, so shift 16-bit lanes and mask off the
+// bits which are shifted in from the neighbour byte.
+template <bool LSB_FIRST>
+BIT_KERNEL_TARGET("sse2")
+static void shiftBlocksSse2(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t shift)
+{
+    __m128i countL = _mm_cvtsi32_si128(LSB_FIRST? (8 - shift): shift);
+    __m128i countR = _mm_cvtsi32_si128(LSB_FIRST? shift: (8 - shift));
+    __m128i maskL = _mm_set1_epi8(
+        char( 0xff << (LSB_FIRST? 8 - shift: shift) )
+    );
+    __m128i maskR = _mm_set1_epi8(
+        char( 0xff >> (LSB_FIRST? shift: 8 - shift) )
+    );
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i cur = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(src + i)
+        );
+        __m128i next = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(src + i + 1)
+        );
+        __m128i hi = LSB_FIRST? next: cur;
+        __m128i lo = LSB_FIRST? cur: next;
+        hi = _mm_and_si128( _mm_sll_epi16(hi, countL), maskL );
+        lo = _mm_and_si128( _mm_srl_epi16(lo, countR), maskR );
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(hi, lo)
+        );
+    }
+    shiftBlocksScalar<LSB_FIRST>(dst + i, src + i, n - i, shift);
+}
+
+template <bool LSB_FIRST>
+BIT_KERNEL_TARGET("avx2")
+static void shiftBlocksAvx2(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t shift)
+{
+    __m128i countL = _mm_cvtsi32_si128(LSB_FIRST? (8 - shift): shift);
+    __m128i countR = _mm_cvtsi32_si128(LSB_FIRST? shift: (8 - shift));
+    __m256i maskL = _mm256_set1_epi8(
+        char( 0xff << (LSB_FIRST? 8 - shift: shift) )
+    );
+    __m256i maskR = _mm256_set1_epi8(
+        char( 0xff >> (LSB_FIRST? shift: 8 - shift) )
+    );
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i cur = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(src + i)
+        );
+        __m256i next = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(src + i + 1)
+        );
+        __m256i hi = LSB_FIRST? next: cur;
+        __m256i lo = LSB_FIRST? cur: next;
+        hi = _mm256_and_si256( _mm256_sll_epi16(hi, countL), maskL );
+        lo = _mm256_and_si256( _mm256_srl_epi16(lo, countR), maskR );
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(hi, lo)
+        );
+    }
+    shiftBlocksSse2<LSB_FIRST>(dst + i, src + i, n - i, shift);
+}
+
+// Swaps the 16-bit words by the shuffles at first for the 32/64-bit items, and
+// then swaps the bytes of each 16-bit word.
+BIT_KERNEL_TARGET("sse2")
+static void byteSwapBlocksSse2(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t itemSize)
+{
+    size_t size = n * itemSize;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i block = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(src + i)
+        );
+        if (4 == itemSize) {
+            block = _mm_shufflelo_epi16( block, _MM_SHUFFLE(2, 3, 0, 1) );
+            block = _mm_shufflehi_epi16( block, _MM_SHUFFLE(2, 3, 0, 1) );
+        } else if (8 == itemSize) {
+            block = _mm_shufflelo_epi16( block, _MM_SHUFFLE(0, 1, 2, 3) );
+            block = _mm_shufflehi_epi16( block, _MM_SHUFFLE(0, 1, 2, 3) );
+        }
+        block = _mm_or_si128(
+            _mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8)
+        );
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), block);
+    }
+    byteSwapBlocksScalar(dst + i, src + i, (size - i) / itemSize, itemSize);
+}
+
+BIT_KERNEL_TARGET("avx2")
+static void byteSwapBlocksAvx2(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t itemSize)
+{
+    // The shuffle works inside each 128-bit lane, which is always a whole
+    // count of items.
+    static const uint8_t SWAP_MASK[3][16] = {
+        {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+        {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+        {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}
+    };
+    const uint8_t * swapMask = SWAP_MASK[(itemSize >> 2) & 3];
+    __m256i mask = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128( reinterpret_cast<const __m128i *>(swapMask) )
+    );
+    size_t size = n * itemSize;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i block = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(src + i)
+        );
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(dst + i),
+            _mm256_shuffle_epi8(block, mask)
+        );
+    }
+    byteSwapBlocksSse2(dst + i, src + i, (size - i) / itemSize, itemSize);
+}
+
+// Compares the 1st. & the last bytes of the pattern at 16/32 candidates at
+// once, and then verifies the candidates whose both bytes are matched.
+BIT_KERNEL_TARGET("sse2")
+static size_t findBytesSse2(
+    const uint8_t * data, size_t size, const uint8_t * pattern, size_t m)
+{
+    __m128i first = _mm_set1_epi8( char(pattern[0]) );
+    __m128i last = _mm_set1_epi8( char(pattern[m - 1]) );
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= size; i += 16) {
+        __m128i eqFirst = _mm_cmpeq_epi8(
+            first,
+            _mm_loadu_si128( reinterpret_cast<const __m128i *>(data + i) )
+        );
+        __m128i eqLast = _mm_cmpeq_epi8(
+            last,
+            _mm_loadu_si128(
+                reinterpret_cast<const __m128i *>(data + i + m - 1)
+            )
+        );
+        uint32_t mask = _mm_movemask_epi8( _mm_and_si128(eqFirst, eqLast) );
+        for (; mask; mask &= mask - 1) {
+            size_t candidate = i + __builtin_ctz(mask);
+            if ( 0 == memcmp(data + candidate, pattern, m) )
+                return candidate;
+        }
+    }
+    return i + findBytesScalar(data + i, size - i, pattern, m);
+}
+
+BIT_KERNEL_TARGET("avx2")
+static size_t findBytesAvx2(
+    const uint8_t * data, size_t size, const uint8_t * pattern, size_t m)
+{
+    __m256i first = _mm256_set1_epi8( char(pattern[0]) );
+    __m256i last = _mm256_set1_epi8( char(pattern[m - 1]) );
+    size_t i = 0;
+    for (; i + m - 1 + 32 <= size; i += 32) {
+        __m256i eqFirst = _mm256_cmpeq_epi8(
+            first,
+            _mm256_loadu_si256( reinterpret_cast<const __m256i *>(data + i) )
+        );
+        __m256i eqLast = _mm256_cmpeq_epi8(
+            last,
+            _mm256_loadu_si256(
+                reinterpret_cast<const __m256i *>(data + i + m - 1)
+            )
+        );
+        uint32_t mask = _mm256_movemask_epi8(
+            _mm256_and_si256(eqFirst, eqLast)
+        );
+        for (; mask; mask &= mask - 1) {
+            size_t candidate = i + __builtin_ctz(mask);
+            if ( 0 == memcmp(data + candidate, pattern, m) )
+                return candidate;
+        }
+    }
+    return i + findBytesSse2(data + i, size - i, pattern, m);
+}
+
+// Folds 4 x 128 bits by the carry-less multiplication, and then reduces them to
+// 32 bits by the Barrett reduction (refer Intel's white paper "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction").
+BIT_KERNEL_TARGET("sse2,pclmul")
+static uint32_t crc32Pclmul(uint32_t crc, const uint8_t * data, size_t size) {
+    if (size < 64)
+        return crc32Scalar<CRC32_IEEE>(crc, data, size);
+    const __m128i * blocks = reinterpret_cast<const __m128i *>(data);
+    __m128i x1 = _mm_loadu_si128(blocks);
+    __m128i x2 = _mm_loadu_si128(blocks + 1);
+    __m128i x3 = _mm_loadu_si128(blocks + 2);
+    __m128i x4 = _mm_loadu_si128(blocks + 3);
+    x1 = _mm_xor_si128( x1, _mm_cvtsi32_si128( int(crc) ) );
+    __m128i k = _mm_set_epi64x(0x01c6e41596LL, 0x0154442bd4LL);
+    size_t i = 64;
+    for (; i + 64 <= size; i += 64) {
+        blocks = reinterpret_cast<const __m128i *>(data + i);
+        __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+        x1 = _mm_xor_si128( _mm_clmulepi64_si128(x1, k, 0x11), x5 );
+        x2 = _mm_xor_si128( _mm_clmulepi64_si128(x2, k, 0x11), x6 );
+        x3 = _mm_xor_si128( _mm_clmulepi64_si128(x3, k, 0x11), x7 );
+        x4 = _mm_xor_si128( _mm_clmulepi64_si128(x4, k, 0x11), x8 );
+        x1 = _mm_xor_si128( x1, _mm_loadu_si128(blocks) );
+        x2 = _mm_xor_si128( x2, _mm_loadu_si128(blocks + 1) );
+        x3 = _mm_xor_si128( x3, _mm_loadu_si128(blocks + 2) );
+        x4 = _mm_xor_si128( x4, _mm_loadu_si128(blocks + 3) );
+    }
+    // Folds into 128 bits, and then the remaining 16-byte blocks.
+    k = _mm_set_epi64x(0x00ccaa009eLL, 0x01751997d0LL);
+    __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_xor_si128( _mm_clmulepi64_si128(x1, k, 0x11), x5 );
+    x1 = _mm_xor_si128(x1, x2);
+    x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_xor_si128( _mm_clmulepi64_si128(x1, k, 0x11), x5 );
+    x1 = _mm_xor_si128(x1, x3);
+    x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+    x1 = _mm_xor_si128( _mm_clmulepi64_si128(x1, k, 0x11), x5 );
+    x1 = _mm_xor_si128(x1, x4);
+    for (; i + 16 <= size; i += 16) {
+        x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_xor_si128( _mm_clmulepi64_si128(x1, k, 0x11), x5 );
+        x1 = _mm_xor_si128(
+            x1, _mm_loadu_si128( reinterpret_cast<const __m128i *>(data + i) )
+        );
+    }
+    // Folds 128 bits to 64 bits.
+    const __m128i mask32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128( _mm_srli_si128(x1, 8), x2 );
+    k = _mm_set_epi64x(0, 0x0163cd6124LL);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_clmulepi64_si128( _mm_and_si128(x1, mask32), k, 0x00 );
+    x1 = _mm_xor_si128(x1, x2);
+    // Barrett reduces to 32 bits.
+    k = _mm_set_epi64x(0x01f7011641LL, 0x01db710641LL);
+    x2 = _mm_clmulepi64_si128( _mm_and_si128(x1, mask32), k, 0x10 );
+    x2 = _mm_clmulepi64_si128( _mm_and_si128(x2, mask32), k, 0x00 );
+    x1 = _mm_xor_si128(x1, x2);
+    crc = uint32_t( _mm_cvtsi128_si32( _mm_srli_si128(x1, 4) ) );
+    return crc32Scalar<CRC32_IEEE>(crc, data + i, size - i);
+}
+
+BIT_KERNEL_TARGET("sse4.2")
+static uint32_t crc32cSse42(uint32_t crc, const uint8_t * data, size_t size) {
+    size_t i = 0;
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t block;
+        memcpy(&block, data + i, 8);
+        crc64 = _mm_crc32_u64(crc64, block);
+    }
+    crc = uint32_t(crc64);
+#endif
+    for (; i + 4 <= size; i += 4) {
+        uint32_t block;
+        memcpy(&block, data + i, 4);
+        crc = _mm_crc32_u32(crc, block);
+    }
+    for (; i < size; ++i)
+        crc = _mm_crc32_u8(crc, data[i]);
+    return crc;
+}
+
+#ifdef __x86_64__
+BIT_KERNEL_TARGET("bmi2")
+static void extractBitsBmi2(
+    uint64_t word, const uint64_t * masks, uint32_t count, uint64_t * out_vals)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        out_vals[i] = _pext_u64(word, masks[i]);
+}
+
+BIT_KERNEL_TARGET("bmi2")
+static uint64_t depositBitsBmi2(
+    const uint64_t * vals, const uint64_t * masks, uint32_t count)
+{
+    uint64_t word = 0;
+    for (uint32_t i = 0; i < count; ++i)
+        word |= _pdep_u64(vals[i], masks[i]);
+    return word;
+}
+#endif // __x86_64__
+
+#endif // BIT_KERNEL_X86
+
+static int selectKernelType() {
+#ifdef BIT_KERNEL_X86
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") )
+        return bit_kernel::KERNEL_AVX2;
+    if ( __builtin_cpu_supports("sse2") )
+        return bit_kernel::KERNEL_SSE2;
+#endif
+    return bit_kernel::KERNEL_SCALAR;
+}
+
+template <bool LSB_FIRST>
+static shift_blocks_kernel selectShiftBlocks(int kernelType) {
+    switch (kernelType) {
+#ifdef BIT_KERNEL_X86
+    case bit_kernel::KERNEL_AVX2:
+        return shiftBlocksAvx2<LSB_FIRST>;
+    case bit_kernel::KERNEL_SSE2:
+        return shiftBlocksSse2<LSB_FIRST>;
+#endif
+    default:
+        return shiftBlocksScalar<LSB_FIRST>;
+    }
+}
+
+static byte_swap_blocks_kernel selectByteSwapBlocks(int kernelType) {
+    switch (kernelType) {
+#ifdef BIT_KERNEL_X86
+    case bit_kernel::KERNEL_AVX2:
+        return byteSwapBlocksAvx2;
+    case bit_kernel::KERNEL_SSE2:
+        return byteSwapBlocksSse2;
+#endif
+    default:
+        return byteSwapBlocksScalar;
+    }
+}
+
+static find_bytes_kernel selectFindBytes(int kernelType) {
+    switch (kernelType) {
+#ifdef BIT_KERNEL_X86
+    case bit_kernel::KERNEL_AVX2:
+        return findBytesAvx2;
+    case bit_kernel::KERNEL_SSE2:
+        return findBytesSse2;
+#endif
+    default:
+        return findBytesScalar;
+    }
+}
+
+// The CRC instructions are beyond the kernel_type tiers, so are checked alone.
+template <int POLY>
+static crc32_kernel selectCrc32() {
+#ifdef BIT_KERNEL_X86
+    __builtin_cpu_init();
+    if ( CRC32_IEEE == POLY && __builtin_cpu_supports("pclmul") )
+        return crc32Pclmul;
+    if ( CRC32_CASTAGNOLI == POLY && __builtin_cpu_supports("sse4.2") )
+        return crc32cSse42;
+#endif
+    return crc32Scalar<POLY>;
+}
+
+// BMI2 is also beyond the kernel_type tiers.
+static bool hasBmi2() {
+#if defined(BIT_KERNEL_X86) && defined(__x86_64__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+static extract_bits_kernel selectExtractBits(bool bmi2) {
+#if defined(BIT_KERNEL_X86) && defined(__x86_64__)
+    if (bmi2)
+        return extractBitsBmi2;
+#endif
+    return extractBitsScalar;
+}
+
+static deposit_bits_kernel selectDepositBits(bool bmi2) {
+#if defined(BIT_KERNEL_X86) && defined(__x86_64__)
+    if (bmi2)
+        return depositBitsBmi2;
+#endif
+    return depositBitsScalar;
+}
+
+template <bool LSB_FIRST>
+static void shiftBlocksResolver(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t shift);
+static void byteSwapBlocksResolver(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t itemSize);
+static size_t findBytesResolver(
+    const uint8_t * data, size_t size, const uint8_t * pattern, size_t m);
+template <int POLY>
+static uint32_t crc32Resolver(uint32_t crc, const uint8_t * data, size_t size);
+static void extractBitsResolver(
+    uint64_t word, const uint64_t * masks, uint32_t count, uint64_t * out_vals);
+static uint64_t depositBitsResolver(
+    const uint64_t * vals, const uint64_t * masks, uint32_t count);
+
+// All are constant-initialized, so they are usable by static constructors of
+// other modules; each resolver replaces itself at the 1st. call, and all of
+// them are replaced by gKernelInitializer.
+static int gKernelType = -1;
+static shift_blocks_kernel gShiftBlocks[2] = {
+    shiftBlocksResolver<false>, shiftBlocksResolver<true>
+};
+static byte_swap_blocks_kernel gByteSwapBlocks = byteSwapBlocksResolver;
+static find_bytes_kernel gFindBytes = findBytesResolver;
+static crc32_kernel gCrc32[2] = {
+    crc32Resolver<CRC32_IEEE>, crc32Resolver<CRC32_CASTAGNOLI>
+};
+static extract_bits_kernel gExtractBits = extractBitsResolver;
+static deposit_bits_kernel gDepositBits = depositBitsResolver;
+
+template <bool LSB_FIRST>
+static void shiftBlocksResolver(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t shift)
+{
+    gShiftBlocks[LSB_FIRST] = \
+        selectShiftBlocks<LSB_FIRST>( bit_kernel::KernelType() );
+    gShiftBlocks[LSB_FIRST](dst, src, n, shift);
+}
+
+static void byteSwapBlocksResolver(
+    uint8_t * dst, const uint8_t * src, size_t n, uint32_t itemSize)
+{
+    gByteSwapBlocks = selectByteSwapBlocks( bit_kernel::KernelType() );
+    gByteSwapBlocks(dst, src, n, itemSize);
+}
+
+static size_t findBytesResolver(
+    const uint8_t * data, size_t size, const uint8_t * pattern, size_t m)
+{
+    gFindBytes = selectFindBytes( bit_kernel::KernelType() );
+    return gFindBytes(data, size, pattern, m);
+}
+
+// The hardware kernels use the table for the short data too.
+template <int POLY>
+static uint32_t crc32Resolver(uint32_t crc, const uint8_t * data, size_t size)
+{
+    buildCrc32Table(POLY);
+    gCrc32[POLY] = selectCrc32<POLY>();
+    return gCrc32[POLY](crc, data, size);
+}
+
+static void extractBitsResolver(
+    uint64_t word, const uint64_t * masks, uint32_t count, uint64_t * out_vals)
+{
+    gExtractBits = selectExtractBits( hasBmi2() );
+    gExtractBits(word, masks, count, out_vals);
+}
+
+static uint64_t depositBitsResolver(
+    const uint64_t * vals, const uint64_t * masks, uint32_t count)
+{
+    gDepositBits = selectDepositBits( hasBmi2() );
+    return gDepositBits(vals, masks, count);
+}
+
+// Resolves all the kernels & builds the tables at the static initialization,
+// that is before main() starts any thread, so they are never written while
+// the threads run; only a static constructor of another module which runs
+// before it resolves a kernel by the resolver (in the single thread).
+static struct kernel_initializer {
+    kernel_initializer() {
+        int kernelType = bit_kernel::KernelType();
+        gShiftBlocks[false] = selectShiftBlocks<false>(kernelType);
+        gShiftBlocks[true] = selectShiftBlocks<true>(kernelType);
+        gByteSwapBlocks = selectByteSwapBlocks(kernelType);
+        gFindBytes = selectFindBytes(kernelType);
+        buildCrc32Table(CRC32_IEEE);
+        buildCrc32Table(CRC32_CASTAGNOLI);
+        gCrc32[CRC32_IEEE] = selectCrc32<CRC32_IEEE>();
+        gCrc32[CRC32_CASTAGNOLI] = selectCrc32<CRC32_CASTAGNOLI>();
+        bool bmi2 = hasBmi2();
+        gExtractBits = selectExtractBits(bmi2);
+        gDepositBits = selectDepositBits(bmi2);
+    }
+} gKernelInitializer;
+
+int bit_kernel::KernelType() {
+    if (gKernelType < 0)
+        gKernelType = selectKernelType();
+    return gKernelType;
+}
+
+void bit_kernel::ShiftBlocks(
+    uint8_t * dst,
+    const uint8_t * src,
+    size_t n,
+    uint32_t shift,
+    bool lsbFirst)
+{
+    gShiftBlocks[lsbFirst](dst, src, n, shift);
+}
+
+void bit_kernel::ByteSwapBlocks(
+    void * dst, const void * src, size_t n, uint32_t itemSize)
+{
+    if (itemSize > 1) {
+        gByteSwapBlocks(
+            static_cast<uint8_t *>(dst),
+            static_cast<const uint8_t *>(src),
+            n,
+            itemSize
+        );
+    } else if (dst != src)
+        memmove(dst, src, n);
+}
+
+size_t bit_kernel::FindBytes(
+    const uint8_t * data,
+    size_t size,
+    const uint8_t * pattern,
+    size_t patternSize)
+{
+    if ( !data || !pattern || 0 == patternSize || patternSize > size )
+        return size;
+    return gFindBytes(data, size, pattern, patternSize);
+}
+
+uint32_t bit_kernel::Crc32(uint32_t crc, const uint8_t * data, size_t size) {
+    return data? ~gCrc32[CRC32_IEEE](~crc, data, size): crc;
+}
+
+uint32_t bit_kernel::Crc32C(uint32_t crc, const uint8_t * data, size_t size) {
+    return data? ~gCrc32[CRC32_CASTAGNOLI](~crc, data, size): crc;
+}
+
+void bit_kernel::ExtractBits(
+    uint64_t word,
+    const uint64_t * masks,
+    uint32_t count,
+    uint64_t * out_vals)
+{
+    gExtractBits(word, masks, count, out_vals);
+}
+
+uint64_t bit_kernel::DepositBits(
+    const uint64_t * vals, const uint64_t * masks, uint32_t count)
+{
+    return gDepositBits(vals, masks, count);
+}
+
+#ifdef BIT_KERNEL_UT
+
+#include <iostream>
+
+int main() {
+    const char * KERNEL_NAME[] = {"scalar", "sse2", "avx2"};
+    const uint32_t BUF_SIZE = 256;
+    uint8_t src[BUF_SIZE + 1], dst[BUF_SIZE], ref[BUF_SIZE];
+    uint32_t seed = 0x87654321;
+    for (uint32_t i = 0; i <= BUF_SIZE; ++i) {
+        seed = seed * 1103515245 + 12345;
+        src[i] = uint8_t(seed >> 16);
+    }
+    std::cout << "selected kernel: " << \
+        KERNEL_NAME[bit_kernel::KernelType()] << std::endl;
+    for (int k = 0; k <= bit_kernel::KernelType(); ++k) {
+        shift_blocks_kernel shiftBlocks[2] = {
+            selectShiftBlocks<false>(k), selectShiftBlocks<true>(k)
+        };
+        for (uint32_t shift = 1; shift < 16; ++shift) {
+            bool lsbFirst = (shift > 7);
+            uint32_t bits = shift & 7;
+            for (uint32_t n = 0; n <= BUF_SIZE && bits; ++n) {
+                memset(dst, 0, BUF_SIZE);
+                for (uint32_t i = 0; i < n; ++i) {
+                    uint8_t cur = src[i], next = src[i + 1];
+                    ref[i] = lsbFirst \
+                        ? uint8_t( cur >> bits | next << (8 - bits) )
+                        : uint8_t( cur << bits | next >> (8 - bits) );
+                }
+                shiftBlocks[lsbFirst](dst, src, n, bits);
+                if ( memcmp(dst, ref, n) ) {
+                    std::cout << KERNEL_NAME[k] << " failed: shift " << \
+                        bits << ( lsbFirst? " (LSB-first)": "" ) << \
+                        ", size " << n << std::endl;
+                    return 1;
+                }
+            }
+        }
+        byte_swap_blocks_kernel byteSwapBlocks = selectByteSwapBlocks(k);
+        for (uint32_t itemSize = 2; itemSize <= 8; itemSize <<= 1) {
+            for (uint32_t n = 0; n <= BUF_SIZE / itemSize; ++n) {
+                for (uint32_t i = 0; i < n * itemSize; ++i) {
+                    uint32_t j = i % itemSize;
+                    ref[i] = src[i - j + itemSize - 1 - j];
+                }
+                memcpy(dst, src, n * itemSize);
+                byteSwapBlocks(dst, dst, n, itemSize);
+                if ( memcmp(dst, ref, n * itemSize) ) {
+                    std::cout << KERNEL_NAME[k] << " byte-swap failed: " << \
+                        itemSize << " bytes, count " << n << std::endl;
+                    return 1;
+                }
+            }
+        }
+        // The patterns are cut from the data, so there is a match at least.
+        find_bytes_kernel findBytes = selectFindBytes(k);
+        for (uint32_t m = 1; m <= 8; ++m) {
+            for (uint32_t start = 0; start + m <= BUF_SIZE; ++start) {
+                const uint8_t * pattern = src + start;
+                size_t expected = 0;
+                while ( memcmp(src + expected, pattern, m) )
+                    ++expected;
+                size_t found = findBytes(src, BUF_SIZE, pattern, m);
+                if (found != expected) {
+                    std::cout << KERNEL_NAME[k] << " find failed: size " << \
+                        m << ", @" << start << std::endl;
+                    return 1;
+                }
+            }
+        }
+        std::cout << KERNEL_NAME[k] << " passed." << std::endl;
+    }
+
+    const uint8_t CHECK_DATA[] = "123456789";
+    if ( bit_kernel::Crc32(0, CHECK_DATA, 9) != 0xcbf43926 || \
+        bit_kernel::Crc32C(0, CHECK_DATA, 9) != 0xe3069283 )
+    {
+        std::cout << "crc32 check value failed." << std::endl;
+        return 1;
+    }
+    // Compares with the bitwise CRC, and the CRC of 2 parts.
+    for (int poly = CRC32_IEEE; poly <= CRC32_CASTAGNOLI; ++poly) {
+        uint32_t (* crc32)(uint32_t, const uint8_t *, size_t) = \
+            (CRC32_IEEE == poly)? bit_kernel::Crc32: bit_kernel::Crc32C;
+        crc32_kernel crc32Table = (CRC32_IEEE == poly) \
+            ? crc32Scalar<CRC32_IEEE>: crc32Scalar<CRC32_CASTAGNOLI>;
+        for (uint32_t start = 0; start < 8; ++start) {
+            uint32_t crc = ~uint32_t(0);
+            for (uint32_t n = 0; start + n <= BUF_SIZE; ++n) {
+                uint32_t half = n / 3;
+                uint32_t result = crc32(
+                    crc32(0, src + start, half),
+                    src + start + half,
+                    n - half
+                );
+                if ( ~crc != result || \
+                    crc != crc32Table(~uint32_t(0), src + start, n) )
+                {
+                    std::cout << "crc32 failed: poly " << poly << \
+                        ", size " << n << ", @" << start << std::endl;
+                    return 1;
+                }
+                if (start + n == BUF_SIZE)
+                    break;
+                crc ^= src[start + n];
+                for (uint32_t j = 0; j < 8; ++j) {
+                    crc = (crc >> 1) ^ \
+                        ( (crc & 1)? CRC32_REFLECTED_POLY[poly]: 0 );
+                }
+            }
+        }
+    }
+    std::cout << "crc32 passed." << std::endl;
+
+    // The random contiguous (even items) & non-contiguous (odd items) masks,
+    // and the values out of the masks.
+    for (int bmi2 = 0; bmi2 <= int( hasBmi2() ); ++bmi2) {
+        extract_bits_kernel extractBits = selectExtractBits(bmi2);
+        deposit_bits_kernel depositBits = selectDepositBits(bmi2);
+        uint64_t masks[16], vals[16], refVals[16];
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint64_t word = 0;
+            for (uint32_t i = 0; i < 16; ++i) {
+                seed = seed * 1103515245 + 12345;
+                uint32_t width = ( (seed >> 8) & 63 ) + 1;
+                uint32_t shift = (seed >> 16) % (65 - width);
+                masks[i] = ( ~uint64_t(0) >> (64 - width) ) << shift;
+                if (i & 1)
+                    masks[i] ^= (word << 7) | 0x8000000000000001ULL;
+                word = (word << 13) ^ (word >> 51) ^ seed;
+            }
+            bool matched = true;
+            for (uint32_t i = 0; i < 16; ++i) {
+                uint64_t val = 0, bit = 1;
+                for (uint32_t j = 0; j < 64; ++j) {
+                    if ( masks[i] & (uint64_t(1) << j) ) {
+                        if ( word & (uint64_t(1) << j) )
+                            val |= bit;
+                        bit <<= 1;
+                    }
+                }
+                refVals[i] = val;
+            }
+            extractBits(word, masks, 16, vals);
+            for (uint32_t i = 0; matched && i < 16; ++i)
+                matched = depositBits(vals + i, masks + i, 1) == \
+                    (word & masks[i]);
+            if ( !matched || memcmp( vals, refVals, sizeof(vals) ) ) {
+                std::cout << "bit group failed: bmi2 " << bmi2 << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "bit group passed." << std::endl;
+    return 0;
+}
+
+#endif // BIT_KERNEL_UT
@@ -0,0 +1,152 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef _BIT_KERNEL_H_
+#define _BIT_KERNEL_H_
+
+#ifndef __cplusplus
+#error The module is NOT compatible with C codes.
+#endif
+
+#include "obj_base.h"
+
+namespace pdl {
+
+// The bulk kernels of bit operations, the best implementation is selected by
+// the CPU features once at the static initialization (before main()), define
+// DISABLE_SIMD to use the scalar implementations only.
+struct bit_kernel {
+    enum kernel_type {
+        KERNEL_SCALAR,
+        KERNEL_SSE2,
+        KERNEL_AVX2
+    };
+
+    // Loads/stores 8 bytes as a big-endian integer, so the 1st. bit is the MSB.
+    static uint64_t LoadBE64(const uint8_t * data) {
+        uint64_t block = 0;
+        for (uint32_t i = 0; i < 8; ++i)
+            block = (block << 8) | data[i];
+        return block;
+    }
+    static void StoreBE64(uint8_t * data, uint64_t block) {
+        for (uint32_t i = 8; i > 0; --i) {
+            data[i - 1] = uint8_t(block);
+            block >>= 8;
+        }
+    }
+    // Loads/stores 8 bytes as a little-endian integer, for the LSB-first bits.
+    static uint64_t LoadLE64(const uint8_t * data) {
+        uint64_t block = 0;
+        for (uint32_t i = 8; i > 0; --i)
+            block = (block << 8) | data[i - 1];
+        return block;
+    }
+    static void StoreLE64(uint8_t * data, uint64_t block) {
+        for (uint32_t i = 0; i < 8; ++i) {
+            data[i] = uint8_t(block);
+            block >>= 8;
+        }
+    }
+    static uint64_t ByteSwap64(uint64_t val) {
+#ifdef __GNUC__
+        return __builtin_bswap64(val);
+#else
+        uint64_t ret = 0;
+        for (uint32_t i = 0; i < 8; ++i, val >>= 8)
+            ret = (ret << 8) | (val & 0xff);
+        return ret;
+#endif
+    }
+
+    // Returns the count of the leading zero bits, 'val' should NOT be 0.
+    static uint32_t CountLeadingZeros64(uint64_t val) {
+#ifdef __GNUC__
+        return __builtin_clzll(val);
+#else
+        uint32_t n = 0;
+        for (uint32_t shift = 32; shift > 0; shift >>= 1) {
+            if ( 0 == ( val >> (64 - shift) ) ) {
+                n += shift;
+                val <<= shift;
+            }
+        }
+        return n;
+#endif
+    }
+
+    // Returns the kernel_type which is selected by the CPU features.
+    static int KernelType();
+
+    // Merges 'n' bytes of 'src' into 'dst' with a left-shift (1 ~ 7 bits):
+    //   dst[i] = (src[i] << shift) | (src[i + 1] >> (8 - shift))
+    // or with a right-shift for the LSB-first bits:
+    //   dst[i] = (src[i] >> shift) | (src[i + 1] << (8 - shift))
+    // so 'src' should have 'n + 1' readable bytes.
+    static void ShiftBlocks(
+        uint8_t * dst,
+        const uint8_t * src,
+        size_t n,
+        uint32_t shift,
+        bool lsbFirst = false
+    );
+
+    // Returns the index of the 1st. 'pattern' in 'data', or 'size' if it is
+    // not found.
+    static size_t FindBytes(
+        const uint8_t * data,
+        size_t size,
+        const uint8_t * pattern,
+        size_t patternSize
+    );
+
+    // Updates the CRC-32 (IEEE 802.3) or CRC-32C (Castagnoli) of the data,
+    // 'crc' is the result of the previous data, or 0 for the 1st. one; both
+    // are the reflected CRCs with the initial & final XOR value 0xffffffff.
+    static uint32_t Crc32(uint32_t crc, const uint8_t * data, size_t size);
+    static uint32_t Crc32C(uint32_t crc, const uint8_t * data, size_t size);
+
+    // Extracts the bits of each mask from 'word' as a right-aligned value, or
+    // deposits the values into the bits of the masks (the other bits are 0),
+    // like PEXT/PDEP; the contiguous masks are the fastest without BMI2.
+    static void ExtractBits(
+        uint64_t word,
+        const uint64_t * masks,
+        uint32_t count,
+        uint64_t * out_vals
+    );
+    static uint64_t DepositBits(
+        const uint64_t * vals, const uint64_t * masks, uint32_t count
+    );
+
+    static bool IsLittleEndian() {
+        const uint16_t probe = 1;
+        return 1 == *reinterpret_cast<const uint8_t *>(&probe);
+    }
+    // Reverses the byte order of 'n' items of 'itemSize' (1, 2, 4 or 8) bytes,
+    // 'dst' may be the same as 'src'.
+    static void ByteSwapBlocks(
+        void * dst, const void * src, size_t n, uint32_t itemSize
+    );
+};
+
+} // namespace pdl
+
+#endif // _BIT_KERNEL_H_
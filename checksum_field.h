@@ -0,0 +1,193 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+#ifndef _CHECKSUM_FIELD_H_
+#define _CHECKSUM_FIELD_H_
+
+#ifndef __cplusplus
+#error The module is NOT compatible with C codes.
+#endif
+
+#include "field_des.h"
+#include "bit_kernel.h"
+
+namespace pdl {
+
+// The checksum algorithms over whole bytes:
+//   FIELD_SIZE: the size (in bit) of the checksum field.
+//   Compute(): returns the checksum of the data.
+
+// CRC-32 of IEEE 802.3 (Ethernet, zlib, PNG).
+struct crc32_algo {
+    enum field_size_value {
+        FIELD_SIZE = 32
+    };
+
+    static uint32_t Compute(const uint8_t * data, size_t size) {
+        return bit_kernel::Crc32(0, data, size);
+    }
+};
+
+// CRC-32C of Castagnoli (iSCSI, SCTP, ext4).
+struct crc32c_algo {
+    enum field_size_value {
+        FIELD_SIZE = 32
+    };
+
+    static uint32_t Compute(const uint8_t * data, size_t size) {
+        return bit_kernel::Crc32C(0, data, size);
+    }
+};
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xffff, not reflected).
+struct crc16_ccitt_algo {
+    enum field_size_value {
+        FIELD_SIZE = 16
+    };
+
+    static uint32_t Compute(const uint8_t * data, size_t size);
+};
+
+// Adler-32 of zlib.
+struct adler32_algo {
+    enum field_size_value {
+        FIELD_SIZE = 32
+    };
+
+    static uint32_t Compute(const uint8_t * data, size_t size);
+};
+
+// The leaf field of a checksum over a range of the preceding bits, which is
+// 'mRangeOffset' bits before the checksum field and 'mRangeSize' bits long
+// (up to the checksum field if 0); the derived class should implement
+// FieldName(), and may override CoveredRange() for a variable range.
+// The checksum is big-endian unless FieldOrder() has FIELD_ORDER_LITTLE_ENDIAN,
+// and the bits are padded with 0 to whole bytes if the range is not aligned.
+// NOTE: DecodeField() outputs the stored checksum and returns false if it is
+// NOT the checksum of the range; EncodeField() ignores 'val' and writes the
+// checksum of the range, so it should be invoked after the covered fields.
+template <typename A>
+class checksum_field: public leaf_field_des {
+    bit_size_t mRangeOffset;
+    bit_size_t mRangeSize;
+
+public:
+    typedef A algo_type;
+
+    explicit checksum_field(bit_size_t rangeOffset, bit_size_t rangeSize = 0) {
+        mRangeOffset = rangeOffset;
+        mRangeSize = rangeSize;
+    }
+
+    // Outputs the absolute bit offset & size of the covered range.
+    virtual bool CoveredRange(
+        bit_ref bitRef, bit_size_t * out_offset, bit_size_t * out_size) const
+    {
+        if ( bitRef.Offset() < mRangeOffset )
+            return false;
+        *out_offset = bitRef.Offset() - mRangeOffset;
+        *out_size = mRangeSize? mRangeSize: mRangeOffset;
+        return true;
+    }
+    bool Compute(bit_ref bitRef, uint32_t * out_checksum) const {
+        bit_size_t offset = 0, size = 0;
+        const buf_val * buf = bitRef.Buf();
+        if ( !buf || !out_checksum || \
+             !CoveredRange(bitRef, &offset, &size) || \
+             offset > bitRef.MaxSize() || size > bitRef.MaxSize() - offset )
+        {
+            return false;
+        }
+        if ( 0 == ( (offset | size) & 7 ) ) {
+            *out_checksum = algo_type::Compute(
+                static_cast<const uint8_t *>( buf->Buf() ) + (offset >> 3),
+                static_cast<size_t>(size >> 3)
+            );
+        } else {
+            buf_val bits;
+            bits.Resize( buf_size_t( (size + 7) >> 3 ) );
+            memset( bits.Buf(), 0, bits.Size() );
+            bit_ref( buf, offset, bitRef.IsLsbFirst() ).ExportBits(size, &bits);
+            *out_checksum = algo_type::Compute(
+                static_cast<const uint8_t *>( bits.Buf() ),
+                static_cast<size_t>( bits.Size() )
+            );
+        }
+        return true;
+    }
+
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 1;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return algo_type::FIELD_SIZE;
+    }
+    virtual bit_size_t ConstFieldSize() const {
+        return algo_type::FIELD_SIZE;
+    }
+    virtual bool DecodeField(bit_ref bitRef, value_obj * out_val) const {
+        uint32_t checksum = 0;
+        unchecked_bit_ref bits;
+        if ( out_val && bitRef.Unchecked(algo_type::FIELD_SIZE, &bits) ) {
+            uint32_t stored = static_cast<uint32_t>(
+                bits.ReadUInt( algo_type::FIELD_SIZE, littleEndian() )
+            );
+            out_val->Reset();
+            val_itf_selector<int_val>::GetInterface(out_val)->Val() = stored;
+            return Compute(bitRef, &checksum) && checksum == stored;
+        }
+        return false;
+    }
+    virtual bool EncodeField(bit_ref bitRef, const value_obj * val) const {
+        uint32_t checksum = 0;
+        unchecked_bit_ref bits;
+        if ( bitRef.IsWritable() && \
+             bitRef.Unchecked(algo_type::FIELD_SIZE, &bits) && \
+             Compute(bitRef, &checksum) )
+        {
+            bits.WriteUInt( algo_type::FIELD_SIZE, checksum, littleEndian() );
+            return true;
+        }
+        return false;
+    }
+
+private:
+    bool littleEndian() const {
+        return 0 != ( this->FieldOrder() & FIELD_ORDER_LITTLE_ENDIAN );
+    }
+};
+
+typedef checksum_field<crc32_algo> crc32_field;
+typedef checksum_field<crc32c_algo> crc32c_field;
+typedef checksum_field<crc16_ccitt_algo> crc16_ccitt_field;
+typedef checksum_field<adler32_algo> adler32_field;
+
+} // namespace pdl
+
+#endif // _CHECKSUM_FIELD_H_
@@ -0,0 +1,743 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+
+#include <ctype.h>
+#include <stdio.h>
+#include "decoder_gen.h"
+
+namespace pdl {
+
+// The helpers of the generated headers, which work like the bit_ref ones.
+static const char * const GEN_HELPERS = \
+    "#ifndef PDL_GEN_HELPERS\n"
+    "#define PDL_GEN_HELPERS\n"
+    "namespace pdl_gen {\n"
+    "\n"
+    "// The 'nbits' bits should be inside one 64-bit window.\n"
+    "inline uint64_t ReadWindow(\n"
+    "    const uint8_t * data,\n"
+    "    uint64_t offset,\n"
+    "    unsigned nbits,\n"
+    "    bool lsbFirst)\n"
+    "{\n"
+    "    const uint8_t * p = data + (offset >> 3);\n"
+    "    unsigned shift = unsigned(offset & 7);\n"
+    "    unsigned n = (shift + nbits + 7) >> 3;\n"
+    "    uint64_t window = 0;\n"
+    "    for (unsigned i = 0; i < n; ++i)\n"
+    "        window |= uint64_t(p[i]) << (lsbFirst? i << 3: 56 - (i << 3));\n"
+    "    if (lsbFirst)\n"
+    "        return (window >> shift) & (~uint64_t(0) >> (64 - nbits));\n"
+    "    return (window << shift) >> (64 - nbits);\n"
+    "}\n"
+    "\n"
+    "inline void WriteWindow(\n"
+    "    uint8_t * data,\n"
+    "    uint64_t offset,\n"
+    "    unsigned nbits,\n"
+    "    uint64_t val,\n"
+    "    bool lsbFirst)\n"
+    "{\n"
+    "    uint8_t * p = data + (offset >> 3);\n"
+    "    unsigned shift = unsigned(offset & 7);\n"
+    "    uint64_t mask = ~uint64_t(0) >> (64 - nbits);\n"
+    "    if (lsbFirst) {\n"
+    "        mask <<= shift;\n"
+    "        val <<= shift;\n"
+    "    } else {\n"
+    "        mask <<= 64 - nbits - shift;\n"
+    "        val = (val << (64 - nbits)) >> shift;\n"
+    "    }\n"
+    "    unsigned n = (shift + nbits + 7) >> 3;\n"
+    "    for (unsigned i = 0; i < n; ++i) {\n"
+    "        unsigned bitPos = lsbFirst? i << 3: 56 - (i << 3);\n"
+    "        uint8_t byteMask = uint8_t(mask >> bitPos);\n"
+    "        p[i] = uint8_t(\n"
+    "            (p[i] & ~byteMask) | (uint8_t(val >> bitPos) & byteMask) );\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "inline uint64_t ByteSwap(uint64_t val, unsigned nbits) {\n"
+    "    uint64_t ret = 0;\n"
+    "    for (unsigned i = 0; i < 8; ++i)\n"
+    "        ret = (ret << 8) | ( (val >> (i << 3)) & 0xff );\n"
+    "    return ret >> (64 - nbits);\n"
+    "}\n"
+    "\n"
+    "// Reads 'nbits' (1 ~ 64) bits like bit_ref::ReadUInt().\n"
+    "inline uint64_t ReadBits(\n"
+    "    const uint8_t * data,\n"
+    "    uint64_t offset,\n"
+    "    unsigned nbits,\n"
+    "    bool lsbFirst,\n"
+    "    bool swap)\n"
+    "{\n"
+    "    uint64_t val = 0;\n"
+    "    if ( (offset & 7) + nbits > 64 ) {\n"
+    "        if (lsbFirst) {\n"
+    "            val = ReadWindow(data, offset + 32, nbits - 32, true) << 32;\n"
+    "            val |= ReadWindow(data, offset, 32, true);\n"
+    "        } else {\n"
+    "            val = ReadWindow(data, offset, nbits - 32, false) << 32;\n"
+    "            val |= ReadWindow(data, offset + nbits - 32, 32, false);\n"
+    "        }\n"
+    "    } else\n"
+    "        val = ReadWindow(data, offset, nbits, lsbFirst);\n"
+    "    return swap? ByteSwap(val, nbits): val;\n"
+    "}\n"
+    "\n"
+    "// Writes 'nbits' (1 ~ 64) bits like bit_ref::WriteUInt().\n"
+    "inline void WriteBits(\n"
+    "    uint8_t * data,\n"
+    "    uint64_t offset,\n"
+    "    unsigned nbits,\n"
+    "    bool lsbFirst,\n"
+    "    bool swap,\n"
+    "    uint64_t val)\n"
+    "{\n"
+    "    if (swap)\n"
+    "        val = ByteSwap(val & (~uint64_t(0) >> (64 - nbits)), nbits);\n"
+    "    if ( (offset & 7) + nbits > 64 ) {\n"
+    "        if (lsbFirst) {\n"
+    "            WriteWindow(data, offset, 32, val, true);\n"
+    "            WriteWindow(data, offset + 32, nbits - 32, val >> 32, true);\n"
+    "        } else {\n"
+    "            WriteWindow(data, offset, nbits - 32, val >> 32, false);\n"
+    "            WriteWindow(data, offset + nbits - 32, 32, val, false);\n"
+    "        }\n"
+    "    } else\n"
+    "        WriteWindow(data, offset, nbits, val, lsbFirst);\n"
+    "}\n"
+    "\n"
+    "} // namespace pdl_gen\n"
+    "#endif // PDL_GEN_HELPERS\n";
+
+enum gen_code_index {
+    GEN_DECODE,
+    GEN_ENCODE,
+    GEN_VISIT,
+    GEN_CODE_COUNT
+};
+
+static std::string genIdentifier(const char * name) {
+    std::string ident(name? name: "");
+    for (size_t i = 0; i < ident.size(); ++i) {
+        if ( !isalnum( static_cast<unsigned char>(ident[i]) ) )
+            ident[i] = '_';
+    }
+    if ( ident.empty() || isdigit( static_cast<unsigned char>(ident[0]) ) )
+        ident.insert(0, "_");
+    return ident;
+}
+
+// The 64-bit FNV-1a digest of the generated text.
+static uint64_t genDigest(const std::string & text) {
+    uint64_t digest = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < text.size(); ++i) {
+        digest ^= static_cast<uint8_t>(text[i]);
+        digest *= 0x100000001b3ULL;
+    }
+    return digest;
+}
+
+static std::string genIndent(uint32_t indent) {
+    return std::string(indent << 2, ' ');
+}
+
+static const char * genUIntType(bit_size_t size) {
+    if (size <= 8)
+        return "uint8_t";
+    if (size <= 16)
+        return "uint16_t";
+    if (size <= 32)
+        return "uint32_t";
+    return "uint64_t";
+}
+
+static void genLeafItem(
+    std::ostringstream * osts,
+    const field_des * fieldDes,
+    uint32_t indent,
+    const std::string & member,
+    const std::string & offsetExpr,
+    const std::string & fieldNumExpr,
+    uint32_t maxFieldNum)
+{
+    bit_size_t size = fieldDes->ConstFieldSize();
+    uint32_t fieldOrder = fieldDes->FieldOrder();
+    bool lsbFirst = 0 != (fieldOrder & FIELD_ORDER_LSB_FIRST);
+    bool swap = lsbFirst != (0 != (fieldOrder & FIELD_ORDER_LITTLE_ENDIAN));
+    std::ostringstream args;
+    args << offsetExpr << ", " << size << ", " << \
+        (lsbFirst? "true": "false") << ", " << (swap? "true": "false");
+    std::string name(fieldDes->FieldName()), quotedName;
+    for (size_t i = 0; i < name.size(); ++i) {
+        if ('"' == name[i] || '\\' == name[i])
+            quotedName += '\\';
+        quotedName += name[i];
+    }
+    osts[GEN_DECODE] << genIndent(indent) << "out_msg->" << member << \
+        " = static_cast<" << genUIntType(size) << ">(" << std::endl << \
+        genIndent(indent + 1) << "pdl_gen::ReadBits(data, " << args.str() << \
+        ") );" << std::endl;
+    osts[GEN_ENCODE] << genIndent(indent) << "pdl_gen::WriteBits(" << \
+        std::endl << genIndent(indent + 1) << "out_data, " << args.str() << \
+        ", msg." << member << " );" << std::endl;
+    osts[GEN_VISIT] << genIndent(indent) << "visitor(" << std::endl << \
+        genIndent(indent + 1) << '"' << quotedName << "\", " << \
+        fieldNumExpr << ", " << maxFieldNum << ", uint64_t(" << offsetExpr << \
+        "), " << size << ',' << std::endl << genIndent(indent + 1) << \
+        "uint64_t(msg." << member << ") );" << std::endl;
+}
+
+bool static_decoder_gen::fieldLayout(
+    const field_des * fieldDes, uint32_t * out_count, bit_size_t * out_itemSize)
+{
+    const field_des * const * depFieldDes = 0;
+    uint32_t depFieldCount = 0;
+    bool isDependency = false;
+    if ( !fieldDes->FinalizedDependency(
+            mFieldDesDep, &depFieldDes, &depFieldCount, &isDependency ) )
+    {
+        depFieldCount = mFieldDesDep->FindWithB(fieldDes, 0);
+    }
+    buf_val emptyBuf;
+    *out_count = depFieldCount? 0: fieldDes->FieldCount(
+        bit_ref(&emptyBuf, 0), 0, 0
+    );
+    *out_itemSize = 0;
+    if (depFieldCount)
+        goto bad_field_des;
+    if ( fieldDes->IsLeaf() ) {
+        bit_size_t size = fieldDes->ConstFieldSize();
+        uint32_t fieldOrder = fieldDes->FieldOrder();
+        bool lsbFirst = 0 != (fieldOrder & FIELD_ORDER_LSB_FIRST);
+        if ( 0 == size || size > 64 || ( (size & 7) && \
+             lsbFirst != (0 != (fieldOrder & FIELD_ORDER_LITTLE_ENDIAN)) ) || \
+             !static_cast<const leaf_field_des *>(fieldDes)->IsRawUInt() )
+        {
+            goto bad_field_des;
+        }
+        *out_itemSize = size;
+        return true;
+    }
+    for (uint32_t i = 0; i < fieldDes->TreeNode()->GetSubNodeCount(); ++i) {
+        field_des_tree::node_ptr_c subNode = \
+            fieldDes->TreeNode()->GetSubNode(i);
+        uint32_t subCount = 0;
+        bit_size_t subItemSize = 0;
+        if ( subNode && \
+             !fieldLayout(subNode->GetValue(), &subCount, &subItemSize) )
+        {
+            return false;
+        }
+        if (subNode)
+            *out_itemSize += subItemSize * subCount;
+    }
+    return true;
+
+bad_field_des:
+    if (!mBadFieldDes)
+        mBadFieldDes = fieldDes;
+    return false;
+}
+
+void static_decoder_gen::genStruct(
+    std::ostream & ost, field_des_tree::node_ptr_c treeNode, uint32_t indent)
+{
+    for (uint32_t i = 0; i < treeNode->GetSubNodeCount(); ++i) {
+        field_des_tree::node_ptr_c subNode = treeNode->GetSubNode(i);
+        uint32_t count = 0;
+        bit_size_t itemSize = 0;
+        if ( !subNode || \
+             !fieldLayout(subNode->GetValue(), &count, &itemSize) || \
+             0 == count )
+        {
+            continue;
+        }
+        const field_des * fieldDes = subNode->GetValue();
+        std::string ident = genIdentifier( fieldDes->FieldName() );
+        if ( fieldDes->IsLeaf() )
+            ost << genIndent(indent) << genUIntType(itemSize) << ' ' << ident;
+        else {
+            ost << genIndent(indent) << "struct " << ident << "_type {" << \
+                std::endl;
+            genStruct(ost, subNode, indent + 1);
+            ost << genIndent(indent) << "} " << ident;
+        }
+        if (count > 1)
+            ost << '[' << count << ']';
+        ost << ';' << std::endl;
+    }
+}
+
+// The items of an array are unrolled with the constant offsets if there are
+// UNROLL_LIMIT items at most, or decoded by a loop with the constant stride.
+void static_decoder_gen::genCode(
+    std::ostringstream * osts,
+    field_des_tree::node_ptr_c treeNode,
+    uint32_t indent,
+    uint32_t loopDepth,
+    const std::string & path,
+    const std::string & offsetExpr,
+    bit_size_t offset)
+{
+    for (uint32_t i = 0; i < treeNode->GetSubNodeCount(); ++i) {
+        field_des_tree::node_ptr_c subNode = treeNode->GetSubNode(i);
+        uint32_t count = 0;
+        bit_size_t itemSize = 0;
+        if ( !subNode || \
+             !fieldLayout(subNode->GetValue(), &count, &itemSize) || \
+             0 == count )
+        {
+            continue;
+        }
+        const field_des * fieldDes = subNode->GetValue();
+        std::string member = path + genIdentifier( fieldDes->FieldName() );
+        if (count <= UNROLL_LIMIT) {
+            for (uint32_t k = 0; k < count; ++k) {
+                std::ostringstream item, itemOffset, fieldNum;
+                item << member;
+                if (count > 1)
+                    item << '[' << k << ']';
+                itemOffset << (offset + itemSize * k) << offsetExpr;
+                fieldNum << (k + 1);
+                if ( fieldDes->IsLeaf() ) {
+                    genLeafItem(
+                        osts,
+                        fieldDes,
+                        indent,
+                        item.str(),
+                        itemOffset.str(),
+                        fieldNum.str(),
+                        count
+                    );
+                } else {
+                    genCode(
+                        osts,
+                        subNode,
+                        indent,
+                        loopDepth,
+                        item.str() + '.',
+                        offsetExpr,
+                        offset + itemSize * k
+                    );
+                }
+            }
+        } else {
+            std::ostringstream var, loopOffsetExpr;
+            var << 'i' << loopDepth;
+            loopOffsetExpr << offsetExpr << " + " << itemSize << " * " << \
+                var.str();
+            for (uint32_t j = 0; j < GEN_CODE_COUNT; ++j) {
+                osts[j] << genIndent(indent) << "for (size_t " << var.str() << \
+                    " = 0; " << var.str() << " < " << count << "; ++" << \
+                    var.str() << ") {" << std::endl;
+            }
+            std::string item = member + '[' + var.str() + ']';
+            if ( fieldDes->IsLeaf() ) {
+                std::ostringstream itemOffset;
+                itemOffset << offset << loopOffsetExpr.str();
+                genLeafItem(
+                    osts,
+                    fieldDes,
+                    indent + 1,
+                    item,
+                    itemOffset.str(),
+                    var.str() + " + 1",
+                    count
+                );
+            } else {
+                genCode(
+                    osts,
+                    subNode,
+                    indent + 1,
+                    loopDepth + 1,
+                    item + '.',
+                    loopOffsetExpr.str(),
+                    offset
+                );
+            }
+            for (uint32_t j = 0; j < GEN_CODE_COUNT; ++j)
+                osts[j] << genIndent(indent) << '}' << std::endl;
+        }
+        offset += itemSize * count;
+    }
+}
+
+bool static_decoder_gen::Generate(
+    const combined_field_des * fieldDes,
+    const field_des_dependency * fieldDesDep,
+    const char * name,
+    std::ostream & ost)
+{
+    mFieldDesDep = fieldDesDep;
+    mBadFieldDes = 0;
+    if ( !fieldDes || !fieldDesDep || !name || !fieldDes->IsCombined() ) {
+        PDL_THROW( std::invalid_argument(
+            "static_decoder_gen::Generate() invalid argument!"
+        ) );
+        return false;
+    }
+    uint32_t count = 0;
+    bit_size_t msgSize = 0;
+    if ( !fieldLayout(fieldDes, &count, &msgSize) )
+        return false;
+    if (count != 1) { // ParseField() repeats the root by its count.
+        mBadFieldDes = fieldDes;
+        return false;
+    }
+
+    std::string ident = genIdentifier(name), guard;
+    for (size_t i = 0; i < ident.size(); ++i)
+        guard += static_cast<char>( toupper(ident[i]) );
+    guard = "_" + guard + "_GEN_H_";
+    std::ostringstream osts[GEN_CODE_COUNT];
+    genCode(osts, fieldDes->TreeNode(), 1, 0, "", "", 0);
+    buf_size_t msgBytes = buf_size_t( (msgSize + 7) >> 3 );
+
+    std::ostringstream text; // the text before the digest.
+    text << "// Generated by pdl::static_decoder_gen from the '" << \
+        fieldDes->FieldName() << "' schema, DON'T edit it." << std::endl << \
+        std::endl << "#ifndef " << guard << std::endl << "#define " << \
+        guard << std::endl << std::endl << "#include <stddef.h>" << \
+        std::endl << "#include <stdint.h>" << std::endl << std::endl << \
+        GEN_HELPERS << std::endl;
+    text << "struct " << ident << " {" << std::endl;
+    genStruct(text, fieldDes->TreeNode(), 1);
+    text << "};" << std::endl << std::endl;
+    text << "// The size (in byte) of the message." << std::endl << \
+        "const size_t " << ident << "_SIZE = " << msgBytes << ';' << \
+        std::endl << std::endl;
+    text << "inline bool Decode(" << std::endl << \
+        "    const uint8_t * data, size_t size, " << ident << " * out_msg)" << \
+        std::endl << '{' << std::endl << "    if (size < " << msgBytes << \
+        ')' << std::endl << "        return false;" << std::endl << \
+        osts[GEN_DECODE].str() << "    return true;" << std::endl << '}' << \
+        std::endl << std::endl;
+    text << "inline bool Encode(" << std::endl << "    const " << ident << \
+        " & msg, uint8_t * out_data, size_t size)" << std::endl << '{' << \
+        std::endl << "    if (size < " << msgBytes << ')' << std::endl << \
+        "        return false;" << std::endl << osts[GEN_ENCODE].str() << \
+        "    return true;" << std::endl << '}' << std::endl << std::endl;
+    text << "template <typename V>" << std::endl << \
+        "inline void Visit(const " << ident << " & msg, V & visitor) {" << \
+        std::endl << osts[GEN_VISIT].str() << '}' << std::endl << std::endl;
+    char digest[32];
+    snprintf(
+        digest,
+        sizeof(digest),
+        "0x%016llxULL",
+        static_cast<unsigned long long>( genDigest( text.str() ) )
+    );
+    ost << text.str() << "// The digest of the text above." << std::endl << \
+        "const uint64_t " << ident << "_DIGEST = " << digest << ';' << \
+        std::endl << std::endl << "#endif // " << guard << std::endl;
+    return true;
+}
+
+} // namespace pdl
+
+#ifdef DECODER_GEN_UT
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include "field_info_conv.h"
+#include "checksum_field.h"
+
+using namespace pdl;
+
+// The SIZE bits integer repeated COUNT times, like the int_field<T> of the
+// FIELD_DES_UT but with any size & field order.
+template <uint32_t SIZE, uint32_t COUNT = 1, uint32_t ORDER = 0>
+class dg_uint_field: public leaf_field_des {
+    const char * mName;
+
+public:
+    explicit dg_uint_field(const char * name) {
+        mName = name;
+    }
+    virtual const char * FieldName() const {
+        return mName;
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return COUNT;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return SIZE;
+    }
+    virtual bit_size_t ConstFieldSize() const {
+        return SIZE;
+    }
+    virtual uint32_t FieldOrder() const {
+        return ORDER;
+    }
+    virtual bool DecodeField(bit_ref bitRef, value_obj * out_val) const {
+        unchecked_bit_ref bits;
+        if ( out_val && bitRef.Unchecked(SIZE, &bits) ) {
+            out_val->Reset();
+            val_itf_selector<int_val>::GetInterface(out_val)->Val() = \
+                static_cast<uint32_t>( bits.ReadUInt( SIZE, \
+                    0 != (ORDER & FIELD_ORDER_LITTLE_ENDIAN) ) );
+            return true;
+        }
+        return false;
+    }
+    virtual bool EncodeField(bit_ref bitRef, const value_obj * val) const {
+        return false;
+    }
+    virtual bool IsRawUInt() const {
+        return true;
+    }
+};
+
+class dg_crc32_field: public crc32_field {
+public:
+    dg_crc32_field(): crc32_field(8) {
+    }
+    virtual const char * FieldName() const {
+        return "crc";
+    }
+};
+
+class dg_group_field: public combined_field_des {
+    const char * mName;
+    uint32_t mCount;
+
+public:
+    dg_group_field(const char * name, uint32_t count) {
+        mName = name;
+        mCount = count;
+    }
+    virtual const char * FieldName() const {
+        return mName;
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return mCount;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return bitRef.MaxSize() - bitRef.Offset();
+    }
+};
+
+// The header generated from the following schema by this module.
+#include "decoder_gen_ut.h"
+
+// Outputs the leaf items like field_info_conv_xml does.
+struct dg_xml_visitor {
+    std::ostream * mOST;
+
+    void operator ()(
+        const char * name,
+        uint32_t fieldNum,
+        uint32_t maxFieldNum,
+        uint64_t offset,
+        uint32_t size,
+        uint64_t val)
+    {
+        *mOST << std::endl << "  <" << name << '-' << fieldNum << \
+            " max_num=\"" << maxFieldNum << "\" pos=\"" << offset << \
+            "\" size=\"" << size << "\" type=\"int\">" << val << "</" << \
+            name << '-' << fieldNum << '>';
+    }
+};
+
+// Removes the empty lines, e.g. the ones of the combined fields which are not
+// output by field_info_conv_xml with FIC_OUTPUT_LEAF_FIELD_ONLY.
+static std::string removeEmptyLines(const std::string & text) {
+    std::istringstream textIn(text);
+    std::string line, ret;
+    while ( std::getline(textIn, line) ) {
+        if (line.find_first_not_of(' ') != std::string::npos)
+            ret += line + '\n';
+    }
+    return ret;
+}
+
+// Returns the '<name>_DIGEST' of the generated header, or 0 if not found.
+static uint64_t headerDigest(const std::string & header, const char * name) {
+    std::string key = std::string("const uint64_t ") + name + "_DIGEST = ";
+    size_t pos = header.find(key);
+    if (pos == std::string::npos)
+        return 0;
+    return strtoull( header.c_str() + pos + key.size(), 0, 16 );
+}
+
+int main() {
+    // dg_msg {
+    //   magic:8, flags:3, mode:5, length:16 (LE),
+    //   entry[10] {id:12, val:20, tag[3]:8}, point[2] {x:16 (LE), y:16},
+    //   lsb:6 & pad:2 (LSB-first, LE), samples[20]:16, empty[0]:8
+    // }
+    const uint32_t LE = FIELD_ORDER_LITTLE_ENDIAN;
+    const uint32_t LSB_LE = FIELD_ORDER_LSB_FIRST | FIELD_ORDER_LITTLE_ENDIAN;
+    dg_group_field msg("dg_msg", 1);
+    dg_uint_field<8> magic("magic");
+    dg_uint_field<3> flags("flags");
+    dg_uint_field<5> mode("mode");
+    dg_uint_field<16,1,LE> length("length");
+    dg_group_field entry("entry", 10);
+    dg_uint_field<12> id("id");
+    dg_uint_field<20> val("val");
+    dg_uint_field<8,3> tag("tag");
+    dg_group_field point("point", 2);
+    dg_uint_field<16,1,LE> x("x");
+    dg_uint_field<16> y("y");
+    dg_uint_field<6,1,LSB_LE> lsb("lsb");
+    dg_uint_field<2,1,LSB_LE> pad("pad");
+    dg_uint_field<16,20> samples("samples");
+    dg_uint_field<8,0> empty("empty");
+    // The fields in pre-order with the index of the parent.
+    field_des * msgFields[] = {
+        &msg, &magic, &flags, &mode, &length, &entry, &id, &val, &tag,
+        &point, &x, &y, &lsb, &pad, &samples, &empty
+    };
+    const uint32_t MSG_FIELD_COUNT = sizeof(msgFields) / sizeof(msgFields[0]);
+    const uint32_t msgParents[MSG_FIELD_COUNT] = {
+        0, 0, 0, 0, 0, 0, 5, 5, 5, 0, 9, 9, 0, 0, 0, 0
+    };
+    field_des_tree::node_ptr msgNodes[MSG_FIELD_COUNT];
+    for (uint32_t i = 0; i < MSG_FIELD_COUNT; ++i) {
+        msgNodes[i] = field_des_tree::CreateNode(msgFields[i]);
+        msgFields[i]->BindTreeNode(msgNodes[i]);
+        if (i) {
+            field_des_tree::node_ptr parentNode = msgNodes[ msgParents[i] ];
+            uint32_t subNodeCount = parentNode->GetSubNodeCount();
+            parentNode->SetSubNodeCapacity(subNodeCount + 1);
+            parentNode->SetSubNode(subNodeCount, msgNodes[i]);
+        }
+    }
+    field_des_tree msgTree(msgNodes[0]); // to delete nodes.
+    field_des_dependency fieldDesDep;
+
+    // The generated header is up to date, i.e. the generator outputs the one
+    // which is compiled in.
+    static_decoder_gen decoderGen;
+    std::ostringstream header;
+    bool ok = decoderGen.Generate(&msg, &fieldDesDep, "dg_msg", header);
+    if ( ok && headerDigest( header.str(), "dg_msg" ) != dg_msg_DIGEST ) {
+        std::ofstream fileOut("decoder_gen_ut.h.new");
+        fileOut << header.str();
+        std::cout << "decoder_gen_ut.h is out of date, see " \
+            "decoder_gen_ut.h.new." << std::endl;
+        ok = false;
+    }
+
+    // The unsupported schema.
+    dg_uint_field<8> count("count");
+    dg_uint_field<8> items("items");
+    dg_group_field varMsg("var_msg", 1);
+    field_des_tree::node_ptr varNode = field_des_tree::CreateNode(&varMsg);
+    varMsg.BindTreeNode(varNode);
+    varNode->SetSubNodeCapacity(2);
+    field_des_tree::node_ptr subNode = field_des_tree::CreateNode(&count);
+    count.BindTreeNode(subNode);
+    varNode->SetSubNode(0, subNode);
+    subNode = field_des_tree::CreateNode(&items);
+    items.BindTreeNode(subNode);
+    varNode->SetSubNode(1, subNode);
+    field_des_tree varTree(varNode); // to delete nodes.
+    field_des_dependency varFieldDesDep;
+    varFieldDesDep.Insert(&count, &items);
+    std::ostringstream varHeader;
+    ok = ok && !decoderGen.Generate(
+            &varMsg, &varFieldDesDep, "var_msg", varHeader ) && \
+        decoderGen.BadFieldDes() == &items && varHeader.str().empty();
+
+    // The checksum is not a plain integer.
+    dg_uint_field<8> body("body");
+    dg_crc32_field crc;
+    dg_group_field crcMsg("crc_msg", 1);
+    field_des_tree::node_ptr crcNode = field_des_tree::CreateNode(&crcMsg);
+    crcMsg.BindTreeNode(crcNode);
+    crcNode->SetSubNodeCapacity(2);
+    subNode = field_des_tree::CreateNode(&body);
+    body.BindTreeNode(subNode);
+    crcNode->SetSubNode(0, subNode);
+    subNode = field_des_tree::CreateNode(&crc);
+    crc.BindTreeNode(subNode);
+    crcNode->SetSubNode(1, subNode);
+    field_des_tree crcTree(crcNode); // to delete nodes.
+    std::ostringstream crcHeader;
+    ok = ok && !decoderGen.Generate(
+            &crcMsg, &varFieldDesDep, "crc_msg", crcHeader ) && \
+        decoderGen.BadFieldDes() == &crc && crcHeader.str().empty();
+
+    // The generated decoder outputs the same xml as ParseField() does.
+    const uint32_t OFLAGS = FIC_OUTPUT_FIELD_NUMBER | \
+        FIC_OUTPUT_MAX_FIELD_NUM | FIC_OUTPUT_FIELD_OFFSET | \
+        FIC_OUTPUT_FIELD_SIZE | FIC_OUTPUT_LEAF_FIELD_ONLY;
+    value_obj bufObj;
+    buf_val * buf = val_itf_selector<buf_val>::GetInterface(&bufObj);
+    buf->Resize(dg_msg_SIZE);
+    uint8_t * data = static_cast<uint8_t *>( buf->Buf() );
+    for (uint32_t round = 0; ok && round < 3; ++round) {
+        uint32_t seed = round * 7919 + 1;
+        for (uint32_t i = 0; i < dg_msg_SIZE; ++i) {
+            seed = seed * 1103515245 + 12345;
+            data[i] = uint8_t(seed >> 16);
+        }
+        std::ostringstream parsedXml;
+        field_info_conv_xml convXml(&parsedXml, OFLAGS);
+        field_info_env env = {&fieldDesDep, buf};
+        msg.ParseField(&convXml, env);
+        convXml.Flush();
+
+        dg_msg decoded;
+        std::ostringstream decodedXml;
+        dg_xml_visitor visitor = {&decodedXml};
+        ok = Decode(data, dg_msg_SIZE, &decoded) && \
+            !Decode(data, dg_msg_SIZE - 1, &decoded);
+        decodedXml << "<?xml version=\"1.0\"?>" << std::endl << \
+            "<protocol-data oflags=\"num|max_num|pos|size|leaf_only\">";
+        Visit(decoded, visitor);
+        decodedXml << std::endl << "</protocol-data>";
+
+        std::vector<uint8_t> encoded(dg_msg_SIZE, 0);
+        ok = ok && removeEmptyLines( decodedXml.str() ) == \
+            removeEmptyLines( parsedXml.str() ) && \
+            Encode(decoded, &(encoded[0]), dg_msg_SIZE) && \
+            0 == memcmp(&(encoded[0]), data, dg_msg_SIZE);
+    }
+
+    std::cout << \
+        (ok? "decoder_gen test passed.": "decoder_gen test failed!") << \
+        std::endl;
+    return ok? 0: 1;
+}
+#endif // DECODER_GEN_UT
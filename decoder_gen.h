@@ -0,0 +1,105 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+
+#ifndef _DECODER_GEN_H_
+#define _DECODER_GEN_H_
+
+#ifndef __cplusplus
+#error The module is NOT compatible with C codes.
+#endif
+
+#include <string>
+#include <sstream>
+#include "field_des.h"
+
+namespace pdl {
+
+// Generates a standalone C++ header for a fixed-layout schema, which holds a
+// plain struct of the fields & the inline functions:
+//   bool Decode(const uint8_t * data, size_t size, <name> * out_msg);
+//   bool Encode(const <name> & msg, uint8_t * out_data, size_t size);
+//   template <typename V> void Visit(const <name> & msg, V & visitor);
+// the offsets are folded into constants & the short arrays are unrolled, so
+// there is no virtual call or field_info in the generated code. Visit() calls
+// 'visitor(name, fieldNumber, maxFieldNum, offset, size, value)' for each leaf
+// item in the order of ParseField(); the '<name>_DIGEST' constant is the
+// digest of the text before it, so a stale header is found by comparing it
+// with the one of the generator output.
+// The schema is supported if each field has no dependency & a constant count
+// (FieldCount() is invoked once without any buffer), and each leaf field is a
+// leaf_field_des::IsRawUInt() one with a ConstFieldSize() of 1 ~ 64 bits; the
+// name of a field is also the member name (the invalid characters are
+// replaced by '_').
+class static_decoder_gen {
+public:
+    enum unroll_limit_value {
+        UNROLL_LIMIT = 8 // the arrays of more items are decoded by loops.
+    };
+
+private:
+    const field_des_dependency * mFieldDesDep;
+    const field_des * mBadFieldDes;
+
+    bool fieldLayout(
+        const field_des * fieldDes,
+        uint32_t * out_count,
+        bit_size_t * out_itemSize
+    );
+    void genStruct(
+        std::ostream & ost,
+        field_des_tree::node_ptr_c treeNode,
+        uint32_t indent
+    );
+    void genCode(
+        std::ostringstream * osts,
+        field_des_tree::node_ptr_c treeNode,
+        uint32_t indent,
+        uint32_t loopDepth,
+        const std::string & path,
+        const std::string & offsetExpr,
+        bit_size_t offset
+    );
+
+public:
+    static_decoder_gen() {
+        mFieldDesDep = 0;
+        mBadFieldDes = 0;
+    }
+
+    // Writes the header of the struct 'name' for the tree of 'fieldDes' into
+    // 'ost', returns false (nothing is written) if the schema is not supported,
+    // see BadFieldDes().
+    bool Generate(
+        const combined_field_des * fieldDes,
+        const field_des_dependency * fieldDesDep,
+        const char * name,
+        std::ostream & ost
+    );
+    // The 1st. field which is not supported by the last Generate().
+    const field_des * BadFieldDes() const {
+        return mBadFieldDes;
+    }
+};
+
+} // namespace pdl
+
+#endif // _DECODER_GEN_H_
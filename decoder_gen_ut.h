@@ -0,0 +1,281 @@
+// Generated by pdl::static_decoder_gen from the 'dg_msg' schema, DON'T edit it.
+
+#ifndef _DG_MSG_GEN_H_
+#define _DG_MSG_GEN_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PDL_GEN_HELPERS
+#define PDL_GEN_HELPERS
+namespace pdl_gen {
+
+// The 'nbits' bits should be inside one 64-bit window.
+inline uint64_t ReadWindow(
+    const uint8_t * data,
+    uint64_t offset,
+    unsigned nbits,
+    bool lsbFirst)
+{
+    const uint8_t * p = data + (offset >> 3);
+    unsigned shift = unsigned(offset & 7);
+    unsigned n = (shift + nbits + 7) >> 3;
+    uint64_t window = 0;
+    for (unsigned i = 0; i < n; ++i)
+        window |= uint64_t(p[i]) << (lsbFirst? i << 3: 56 - (i << 3));
+    if (lsbFirst)
+        return (window >> shift) & (~uint64_t(0) >> (64 - nbits));
+    return (window << shift) >> (64 - nbits);
+}
+
+inline void WriteWindow(
+    uint8_t * data,
+    uint64_t offset,
+    unsigned nbits,
+    uint64_t val,
+    bool lsbFirst)
+{
+    uint8_t * p = data + (offset >> 3);
+    unsigned shift = unsigned(offset & 7);
+    uint64_t mask = ~uint64_t(0) >> (64 - nbits);
+    if (lsbFirst) {
+        mask <<= shift;
+        val <<= shift;
+    } else {
+        mask <<= 64 - nbits - shift;
+        val = (val << (64 - nbits)) >> shift;
+    }
+    unsigned n = (shift + nbits + 7) >> 3;
+    for (unsigned i = 0; i < n; ++i) {
+        unsigned bitPos = lsbFirst? i << 3: 56 - (i << 3);
+        uint8_t byteMask = uint8_t(mask >> bitPos);
+        p[i] = uint8_t(
+            (p[i] & ~byteMask) | (uint8_t(val >> bitPos) & byteMask) );
+    }
+}
+
+inline uint64_t ByteSwap(uint64_t val, unsigned nbits) {
+    uint64_t ret = 0;
+    for (unsigned i = 0; i < 8; ++i)
+        ret = (ret << 8) | ( (val >> (i << 3)) & 0xff );
+    return ret >> (64 - nbits);
+}
+
+// Reads 'nbits' (1 ~ 64) bits like bit_ref::ReadUInt().
+inline uint64_t ReadBits(
+    const uint8_t * data,
+    uint64_t offset,
+    unsigned nbits,
+    bool lsbFirst,
+    bool swap)
+{
+    uint64_t val = 0;
+    if ( (offset & 7) + nbits > 64 ) {
+        if (lsbFirst) {
+            val = ReadWindow(data, offset + 32, nbits - 32, true) << 32;
+            val |= ReadWindow(data, offset, 32, true);
+        } else {
+            val = ReadWindow(data, offset, nbits - 32, false) << 32;
+            val |= ReadWindow(data, offset + nbits - 32, 32, false);
+        }
+    } else
+        val = ReadWindow(data, offset, nbits, lsbFirst);
+    return swap? ByteSwap(val, nbits): val;
+}
+
+// Writes 'nbits' (1 ~ 64) bits like bit_ref::WriteUInt().
+inline void WriteBits(
+    uint8_t * data,
+    uint64_t offset,
+    unsigned nbits,
+    bool lsbFirst,
+    bool swap,
+    uint64_t val)
+{
+    if (swap)
+        val = ByteSwap(val & (~uint64_t(0) >> (64 - nbits)), nbits);
+    if ( (offset & 7) + nbits > 64 ) {
+        if (lsbFirst) {
+            WriteWindow(data, offset, 32, val, true);
+            WriteWindow(data, offset + 32, nbits - 32, val >> 32, true);
+        } else {
+            WriteWindow(data, offset, nbits - 32, val >> 32, false);
+            WriteWindow(data, offset + nbits - 32, 32, val, false);
+        }
+    } else
+        WriteWindow(data, offset, nbits, val, lsbFirst);
+}
+
+} // namespace pdl_gen
+#endif // PDL_GEN_HELPERS
+
+struct dg_msg {
+    uint8_t magic;
+    uint8_t flags;
+    uint8_t mode;
+    uint16_t length;
+    struct entry_type {
+        uint16_t id;
+        uint32_t val;
+        uint8_t tag[3];
+    } entry[10];
+    struct point_type {
+        uint16_t x;
+        uint16_t y;
+    } point[2];
+    uint8_t lsb;
+    uint8_t pad;
+    uint16_t samples[20];
+};
+
+// The size (in byte) of the message.
+const size_t dg_msg_SIZE = 123;
+
+inline bool Decode(
+    const uint8_t * data, size_t size, dg_msg * out_msg)
+{
+    if (size < 123)
+        return false;
+    out_msg->magic = static_cast<uint8_t>(
+        pdl_gen::ReadBits(data, 0, 8, false, false) );
+    out_msg->flags = static_cast<uint8_t>(
+        pdl_gen::ReadBits(data, 8, 3, false, false) );
+    out_msg->mode = static_cast<uint8_t>(
+        pdl_gen::ReadBits(data, 11, 5, false, false) );
+    out_msg->length = static_cast<uint16_t>(
+        pdl_gen::ReadBits(data, 16, 16, false, true) );
+    for (size_t i0 = 0; i0 < 10; ++i0) {
+        out_msg->entry[i0].id = static_cast<uint16_t>(
+            pdl_gen::ReadBits(data, 32 + 56 * i0, 12, false, false) );
+        out_msg->entry[i0].val = static_cast<uint32_t>(
+            pdl_gen::ReadBits(data, 44 + 56 * i0, 20, false, false) );
+        out_msg->entry[i0].tag[0] = static_cast<uint8_t>(
+            pdl_gen::ReadBits(data, 64 + 56 * i0, 8, false, false) );
+        out_msg->entry[i0].tag[1] = static_cast<uint8_t>(
+            pdl_gen::ReadBits(data, 72 + 56 * i0, 8, false, false) );
+        out_msg->entry[i0].tag[2] = static_cast<uint8_t>(
+            pdl_gen::ReadBits(data, 80 + 56 * i0, 8, false, false) );
+    }
+    out_msg->point[0].x = static_cast<uint16_t>(
+        pdl_gen::ReadBits(data, 592, 16, false, true) );
+    out_msg->point[0].y = static_cast<uint16_t>(
+        pdl_gen::ReadBits(data, 608, 16, false, false) );
+    out_msg->point[1].x = static_cast<uint16_t>(
+        pdl_gen::ReadBits(data, 624, 16, false, true) );
+    out_msg->point[1].y = static_cast<uint16_t>(
+        pdl_gen::ReadBits(data, 640, 16, false, false) );
+    out_msg->lsb = static_cast<uint8_t>(
+        pdl_gen::ReadBits(data, 656, 6, true, false) );
+    out_msg->pad = static_cast<uint8_t>(
+        pdl_gen::ReadBits(data, 662, 2, true, false) );
+    for (size_t i0 = 0; i0 < 20; ++i0) {
+        out_msg->samples[i0] = static_cast<uint16_t>(
+            pdl_gen::ReadBits(data, 664 + 16 * i0, 16, false, false) );
+    }
+    return true;
+}
+
+inline bool Encode(
+    const dg_msg & msg, uint8_t * out_data, size_t size)
+{
+    if (size < 123)
+        return false;
+    pdl_gen::WriteBits(
+        out_data, 0, 8, false, false, msg.magic );
+    pdl_gen::WriteBits(
+        out_data, 8, 3, false, false, msg.flags );
+    pdl_gen::WriteBits(
+        out_data, 11, 5, false, false, msg.mode );
+    pdl_gen::WriteBits(
+        out_data, 16, 16, false, true, msg.length );
+    for (size_t i0 = 0; i0 < 10; ++i0) {
+        pdl_gen::WriteBits(
+            out_data, 32 + 56 * i0, 12, false, false, msg.entry[i0].id );
+        pdl_gen::WriteBits(
+            out_data, 44 + 56 * i0, 20, false, false, msg.entry[i0].val );
+        pdl_gen::WriteBits(
+            out_data, 64 + 56 * i0, 8, false, false, msg.entry[i0].tag[0] );
+        pdl_gen::WriteBits(
+            out_data, 72 + 56 * i0, 8, false, false, msg.entry[i0].tag[1] );
+        pdl_gen::WriteBits(
+            out_data, 80 + 56 * i0, 8, false, false, msg.entry[i0].tag[2] );
+    }
+    pdl_gen::WriteBits(
+        out_data, 592, 16, false, true, msg.point[0].x );
+    pdl_gen::WriteBits(
+        out_data, 608, 16, false, false, msg.point[0].y );
+    pdl_gen::WriteBits(
+        out_data, 624, 16, false, true, msg.point[1].x );
+    pdl_gen::WriteBits(
+        out_data, 640, 16, false, false, msg.point[1].y );
+    pdl_gen::WriteBits(
+        out_data, 656, 6, true, false, msg.lsb );
+    pdl_gen::WriteBits(
+        out_data, 662, 2, true, false, msg.pad );
+    for (size_t i0 = 0; i0 < 20; ++i0) {
+        pdl_gen::WriteBits(
+            out_data, 664 + 16 * i0, 16, false, false, msg.samples[i0] );
+    }
+    return true;
+}
+
+template <typename V>
+inline void Visit(const dg_msg & msg, V & visitor) {
+    visitor(
+        "magic", 1, 1, uint64_t(0), 8,
+        uint64_t(msg.magic) );
+    visitor(
+        "flags", 1, 1, uint64_t(8), 3,
+        uint64_t(msg.flags) );
+    visitor(
+        "mode", 1, 1, uint64_t(11), 5,
+        uint64_t(msg.mode) );
+    visitor(
+        "length", 1, 1, uint64_t(16), 16,
+        uint64_t(msg.length) );
+    for (size_t i0 = 0; i0 < 10; ++i0) {
+        visitor(
+            "id", 1, 1, uint64_t(32 + 56 * i0), 12,
+            uint64_t(msg.entry[i0].id) );
+        visitor(
+            "val", 1, 1, uint64_t(44 + 56 * i0), 20,
+            uint64_t(msg.entry[i0].val) );
+        visitor(
+            "tag", 1, 3, uint64_t(64 + 56 * i0), 8,
+            uint64_t(msg.entry[i0].tag[0]) );
+        visitor(
+            "tag", 2, 3, uint64_t(72 + 56 * i0), 8,
+            uint64_t(msg.entry[i0].tag[1]) );
+        visitor(
+            "tag", 3, 3, uint64_t(80 + 56 * i0), 8,
+            uint64_t(msg.entry[i0].tag[2]) );
+    }
+    visitor(
+        "x", 1, 1, uint64_t(592), 16,
+        uint64_t(msg.point[0].x) );
+    visitor(
+        "y", 1, 1, uint64_t(608), 16,
+        uint64_t(msg.point[0].y) );
+    visitor(
+        "x", 1, 1, uint64_t(624), 16,
+        uint64_t(msg.point[1].x) );
+    visitor(
+        "y", 1, 1, uint64_t(640), 16,
+        uint64_t(msg.point[1].y) );
+    visitor(
+        "lsb", 1, 1, uint64_t(656), 6,
+        uint64_t(msg.lsb) );
+    visitor(
+        "pad", 1, 1, uint64_t(662), 2,
+        uint64_t(msg.pad) );
+    for (size_t i0 = 0; i0 < 20; ++i0) {
+        visitor(
+            "samples", i0 + 1, 20, uint64_t(664 + 16 * i0), 16,
+            uint64_t(msg.samples[i0]) );
+    }
+}
+
+// The digest of the text above.
+const uint64_t dg_msg_DIGEST = 0x6f1c0f15b083e19cULL;
+
+#endif // _DG_MSG_GEN_H_
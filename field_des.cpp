@@ -20,11 +20,11 @@ SOFTWARE. */
 
 #include <errno.h>
 #include "field_des.h"
+#include "bit_kernel.h"
 
 using namespace pdl;
 
 extern mem_allocator * gFieldDesAllocator;
-static field_info_backtrace_buf gBacktraceItemPool;
 
 void field_info::OverlayAllocator(mem_allocator * memAllocator) {
     gFieldDesAllocator = memAllocator;
@@ -34,66 +34,463 @@ mem_allocator * field_info::Allocator() {
     return gFieldDesAllocator;
 }
 
-uint32_t bit_ref::copyBits(
+// The caller should make sure both ranges are inside the buffers.
+void bit_ref::copyBitsImp(
+    const uint8_t * src,
+    bit_size_t srcOffset,
+    uint8_t * dst,
+    bit_size_t dstOffset,
+    bit_size_t length,
+    bool lsbFirst)
+{
+    // copy the head bits bit by bit until 'dst' is byte aligned.
+    for (; length && (dstOffset & 7); ++srcOffset, ++dstOffset, --length) {
+        if ( src[blockIdx(srcOffset)] & bitMask(srcOffset, lsbFirst) )
+            dst[blockIdx(dstOffset)] |= bitMask(dstOffset, lsbFirst);
+        else
+            dst[blockIdx(dstOffset)] &= ~ bitMask(dstOffset, lsbFirst);
+    }
+    buf_size_t n = blockIdx(length); // the count of whole 'dst' bytes.
+    if (n) {
+        const uint8_t * srcBlock = src + blockIdx(srcOffset);
+        uint8_t * dstBlock = dst + blockIdx(dstOffset);
+        uint32_t shift = srcOffset & 7;
+        if (0 == shift)
+            memmove(dstBlock, srcBlock, n);
+        else // the 'shift + 8n' bits are inside 'src', so 'srcBlock[n]' is too.
+            bit_kernel::ShiftBlocks(dstBlock, srcBlock, n, shift, lsbFirst);
+        srcOffset += bit_size_t(n) << 3;
+        dstOffset += bit_size_t(n) << 3;
+        length &= 7;
+    }
+    // copy the tail bits bit by bit.
+    for (; length; ++srcOffset, ++dstOffset, --length) {
+        if ( src[blockIdx(srcOffset)] & bitMask(srcOffset, lsbFirst) )
+            dst[blockIdx(dstOffset)] |= bitMask(dstOffset, lsbFirst);
+        else
+            dst[blockIdx(dstOffset)] &= ~ bitMask(dstOffset, lsbFirst);
+    }
+}
+
+bit_size_t bit_ref::copyBits(
     const buf_val * src,
     buf_val * dst,
-    uint32_t srcOffset,
-    uint32_t dstOffset,
-    uint32_t length)
+    bit_size_t srcOffset,
+    bit_size_t dstOffset,
+    bit_size_t length,
+    bool lsbFirst)
 {
+    if ( dst && dst->IsReadOnly() ) {
+        PDL_THROW( std::runtime_error("bit_ref::copyBits() read-only!") );
+        return 0;
+    }
     if (  src && dst && length && \
-        srcOffset < ( src->Size() << 3 ) && dstOffset < ( dst->Size() << 3 )  )
+        srcOffset < BitsOf( src->Size() ) && dstOffset < BitsOf( dst->Size() )  )
     {
-        bit_ref copySrc(src, srcOffset), copyDst(dst, dstOffset);
-        uint32_t maxLength = copySrc.MaxSize() - srcOffset;
+        bit_size_t maxLength = BitsOf( src->Size() ) - srcOffset;
+        if (length > maxLength)
+            length = maxLength;
+        maxLength = bit_size_t(-1) - dstOffset; // the max addressable bits.
         if (length > maxLength)
             length = maxLength;
-        if (copyDst.MaxSize() < length + dstOffset) {
-            uint32_t bitsBufSize = ( (length + dstOffset) >> 3 );
+        if ( BitsOf( dst->Size() ) - dstOffset < length ) {
+            buf_size_t bitsBufSize = blockIdx(length + dstOffset);
             if ( (length + dstOffset) & 7 )
                 ++bitsBufSize;
             dst->Resize(bitsBufSize);
         }
-        for (uint32_t i = 0; i < length; ++i) {
-            copyDst.setVal( copySrc.getVal() );
-            ++copySrc.mOffset;
-            ++copyDst.mOffset;
-        }
+        copyBitsImp(
+            static_cast<const uint8_t *>( src->Buf() ),
+            srcOffset,
+            static_cast<uint8_t *>( dst->Buf() ),
+            dstOffset,
+            length,
+            lsbFirst
+        );
         return length;
     }
     return 0;
 }
 
-uint32_t bit_ref::copyBits(
+bit_size_t bit_ref::copyBits(
     const uint8_t * src,
-    uint32_t srcSize,
-    uint32_t srcOffset,
+    buf_size_t srcSize,
+    bit_size_t srcOffset,
     uint8_t * dst,
-    uint32_t dstSize,
-    uint32_t dstOffset,
-    uint32_t length)
+    buf_size_t dstSize,
+    bit_size_t dstOffset,
+    bit_size_t length,
+    bool lsbFirst)
 {
     if ( src && dst && length && \
-        srcOffset < (srcSize << 3) && dstOffset < (dstSize << 3) )
+        srcOffset < BitsOf(srcSize) && dstOffset < BitsOf(dstSize) )
     {
-        uint32_t maxLength[2] = {
-            (srcSize << 3) - srcOffset, (dstSize << 3) - dstOffset
+        bit_size_t maxLength[2] = {
+            BitsOf(srcSize) - srcOffset, BitsOf(dstSize) - dstOffset
         };
         if (length > maxLength[0])
             length = maxLength[0];
         if (length > maxLength[1])
             length = maxLength[1];
-        for (uint32_t i = 0; i < length; ++i) {
-            if ( src[blockIdx(srcOffset + i)] & bitMask(srcOffset + i) )
-                dst[blockIdx(dstOffset + i)] |= bitMask(dstOffset + i);
-            else
-                dst[blockIdx(dstOffset + i)] &= ~ bitMask(dstOffset + i);
-        }
+        copyBitsImp(src, srcOffset, dst, dstOffset, length, lsbFirst);
         return length;
     }
     return 0;
 }
 
+bool bit_ref::checkIntRange(
+    const char * errTag, uint32_t nbits, bool littleEndian) const
+{
+    if ( 0 == nbits || nbits > 64 || \
+         ( littleEndian != mLsbFirst && nbits > 8 && (nbits & 7) ) )
+    {
+        PDL_THROW( std::invalid_argument(
+            std::string(errTag) + " invalid argument!"
+        ) );
+        return false;
+    }
+    if ( !IsValid() || nbits > MaxSize() - mOffset ) {
+        PDL_THROW( std::overflow_error( std::string(errTag) + " overflow!" ) );
+        return false;
+    }
+    return true;
+}
+
+// The 'nbits' bits should be inside one 64-bit window, that means
+// '(offset & 7) + nbits <= 64'; the window is loaded as a big-endian integer
+// for the MSB-first bits, or a little-endian one for the LSB-first bits.
+uint64_t bit_ref::readBits(
+    const uint8_t * data,
+    buf_size_t size,
+    bit_size_t offset,
+    uint32_t nbits,
+    bool lsbFirst)
+{
+    data += blockIdx(offset);
+    uint32_t shift = offset & 7;
+    uint64_t window = 0;
+    if (blockIdx(offset) + 8 <= size) {
+        window = lsbFirst? bit_kernel::LoadLE64(data): \
+            bit_kernel::LoadBE64(data);
+    } else {
+        uint32_t n = (shift + nbits + 7) >> 3;
+        for (uint32_t i = 0; i < n; ++i)
+            window |= uint64_t(data[i]) << ( lsbFirst? i << 3: 56 - (i << 3) );
+    }
+    if (lsbFirst)
+        return (window >> shift) & ( ~uint64_t(0) >> (64 - nbits) );
+    return (window << shift) >> (64 - nbits);
+}
+
+void bit_ref::writeBits(
+    uint8_t * data,
+    buf_size_t size,
+    bit_size_t offset,
+    uint32_t nbits,
+    uint64_t val,
+    bool lsbFirst)
+{
+    data += blockIdx(offset);
+    uint32_t shift = offset & 7;
+    uint64_t mask = ~uint64_t(0) >> (64 - nbits);
+    if (lsbFirst) {
+        mask <<= shift;
+        val <<= shift;
+    } else {
+        mask <<= 64 - nbits - shift;
+        val = (val << (64 - nbits)) >> shift;
+    }
+    if (blockIdx(offset) + 8 <= size) {
+        if (lsbFirst) {
+            uint64_t window = bit_kernel::LoadLE64(data);
+            bit_kernel::StoreLE64( data, (window & ~mask) | (val & mask) );
+        } else {
+            uint64_t window = bit_kernel::LoadBE64(data);
+            bit_kernel::StoreBE64( data, (window & ~mask) | (val & mask) );
+        }
+    } else {
+        uint32_t n = (shift + nbits + 7) >> 3;
+        for (uint32_t i = 0; i < n; ++i) {
+            uint32_t bitPos = lsbFirst? i << 3: 56 - (i << 3);
+            uint8_t byteMask = uint8_t(mask >> bitPos);
+            data[i] = \
+                (data[i] & ~byteMask) | ( uint8_t(val >> bitPos) & byteMask );
+        }
+    }
+}
+
+// The integer is split into 2 windows if it is too long, the 1st. one holds the
+// high bits for the MSB-first bits, or the low bits for the LSB-first bits.
+uint64_t bit_ref::readUInt(
+    const uint8_t * data,
+    buf_size_t size,
+    bit_size_t offset,
+    uint32_t nbits,
+    bool littleEndian,
+    bool lsbFirst)
+{
+    uint64_t val = 0;
+    if ( (offset & 7) + nbits > 64 ) {
+        if (lsbFirst) {
+            val = readBits(data, size, offset, 32, true) | \
+                ( readBits(data, size, offset + 32, nbits - 32, true) << 32 );
+        } else {
+            val = ( readBits(data, size, offset, nbits - 32, false) << 32 ) | \
+                readBits(data, size, offset + nbits - 32, 32, false);
+        }
+    } else
+        val = readBits(data, size, offset, nbits, lsbFirst);
+    if (littleEndian != lsbFirst && nbits > 8) // no byte order in a byte.
+        val = bit_kernel::ByteSwap64(val) >> (64 - nbits);
+    return val;
+}
+
+void bit_ref::writeUInt(
+    uint8_t * data,
+    buf_size_t size,
+    bit_size_t offset,
+    uint32_t nbits,
+    uint64_t val,
+    bool littleEndian,
+    bool lsbFirst)
+{
+    if (littleEndian != lsbFirst && nbits > 8) {
+        val &= ~uint64_t(0) >> (64 - nbits);
+        val = bit_kernel::ByteSwap64(val) >> (64 - nbits);
+    }
+    if ( (offset & 7) + nbits > 64 ) {
+        if (lsbFirst) {
+            writeBits(data, size, offset, 32, val, true);
+            writeBits(data, size, offset + 32, nbits - 32, val >> 32, true);
+        } else {
+            writeBits(data, size, offset, nbits - 32, val >> 32, false);
+            writeBits(data, size, offset + nbits - 32, 32, val, false);
+        }
+    } else
+        writeBits(data, size, offset, nbits, val, lsbFirst);
+}
+
+uint64_t bit_ref::ReadUInt(uint32_t nbits, bool littleEndian) const {
+    if ( checkIntRange("bit_ref::ReadUInt()", nbits, littleEndian) ) {
+        return readUInt(
+            static_cast<const uint8_t *>( mBuf->Buf() ),
+            mBuf->Size(),
+            mOffset,
+            nbits,
+            littleEndian,
+            mLsbFirst
+        );
+    }
+    return 0;
+}
+
+bool bit_ref::WriteUInt(uint32_t nbits, uint64_t val, bool littleEndian) {
+    if ( checkWritable("bit_ref::WriteUInt()") && \
+         checkIntRange("bit_ref::WriteUInt()", nbits, littleEndian) )
+    {
+        writeUInt(
+            static_cast<uint8_t *>( mBuf->Buf() ),
+            mBuf->Size(),
+            mOffset,
+            nbits,
+            val,
+            littleEndian,
+            mLsbFirst
+        );
+        return true;
+    }
+    return false;
+}
+
+uint32_t bit_ref::readUInts(
+    uint32_t nbits,
+    uint32_t count,
+    void * out_vals,
+    uint32_t valSize,
+    bool littleEndian) const
+{
+    if ( 0 == nbits || nbits > (valSize << 3) || !IsValid() || \
+         ( littleEndian != mLsbFirst && nbits > 8 && (nbits & 7) ) )
+        return 0;
+    bit_size_t maxCount = (MaxSize() - mOffset) / nbits;
+    if (count > maxCount)
+        count = static_cast<uint32_t>(maxCount);
+    if ( nbits == (valSize << 3) ) {
+        // Aligns the bits by the bulk copy, and then fixes the byte order.
+        copyBitsImp(
+            static_cast<const uint8_t *>( mBuf->Buf() ),
+            mOffset,
+            static_cast<uint8_t *>(out_vals),
+            0,
+            bit_size_t(count) * nbits,
+            mLsbFirst
+        );
+        // The copied bytes of each item are in the requested byte order.
+        if ( bit_kernel::IsLittleEndian() != littleEndian )
+            bit_kernel::ByteSwapBlocks(out_vals, out_vals, count, valSize);
+        return count;
+    }
+    const uint8_t * data = static_cast<const uint8_t *>( mBuf->Buf() );
+    buf_size_t size = mBuf->Size();
+    bit_size_t offset = mOffset;
+    for (uint32_t i = 0; i < count; ++i, offset += nbits) {
+        uint64_t val = readUInt(
+            data, size, offset, nbits, littleEndian, mLsbFirst
+        );
+        switch (valSize) {
+        case 1:
+            static_cast<uint8_t *>(out_vals)[i] = uint8_t(val);
+            break;
+        case 2:
+            static_cast<uint16_t *>(out_vals)[i] = uint16_t(val);
+            break;
+        case 4:
+            static_cast<uint32_t *>(out_vals)[i] = uint32_t(val);
+            break;
+        default:
+            static_cast<uint64_t *>(out_vals)[i] = val;
+            break;
+        }
+    }
+    return count;
+}
+
+bit_size_t bit_ref::FindBytes(
+    const uint8_t * pattern, buf_size_t size) const
+{
+    bit_size_t maxSize = MaxSize();
+    if ( !pattern || 0 == size || mOffset >= maxSize )
+        return maxSize;
+    buf_size_t start = blockIdx(mOffset) + ( (mOffset & 7)? 1: 0 );
+    if ( start >= mBuf->Size() )
+        return maxSize;
+    const uint8_t * data = static_cast<const uint8_t *>( mBuf->Buf() );
+    size_t remain = static_cast<size_t>(mBuf->Size() - start);
+    size_t idx = bit_kernel::FindBytes(data + start, remain, pattern, size);
+    return (idx < remain)? BitsOf(start + idx): maxSize;
+}
+
+bit_size_t bit_ref::FindBits(uint64_t pattern, uint32_t nbits) const {
+    bit_size_t maxSize = MaxSize();
+    if ( 0 == nbits || nbits > 57 || mOffset >= maxSize )
+        return maxSize;
+    const uint8_t * data = static_cast<const uint8_t *>( mBuf->Buf() );
+    buf_size_t size = mBuf->Size();
+    uint64_t mask = ~uint64_t(0) >> (64 - nbits);
+    pattern &= mask;
+    // Loads a window per byte, and matches the pattern at the 8 bit offsets.
+    for (buf_size_t i = blockIdx(mOffset); i < size; ++i) {
+        bit_size_t base = BitsOf(i);
+        bit_size_t remain = maxSize - base;
+        uint32_t windowSize = (remain < 64)? uint32_t(remain): 64;
+        if (windowSize < nbits)
+            break;
+        uint64_t window = readBits(data, size, base, windowSize, mLsbFirst);
+        uint32_t shift = (base < mOffset)? uint32_t(mOffset - base): 0;
+        for (; shift < 8 && shift + nbits <= windowSize; ++shift) {
+            uint64_t val = mLsbFirst? (window >> shift): \
+                ( window >> (windowSize - shift - nbits) );
+            if ( (val & mask) == pattern )
+                return base + shift;
+        }
+    }
+    return maxSize;
+}
+
+bit_reader::bit_reader(
+    const uint8_t * data, buf_size_t size, bit_size_t offset)
+{
+    mData = data;
+    mSize = data? size: 0;
+    mMaxSize = bit_ref::BitsOf(mSize);
+    mNextOffset = (offset < mMaxSize)? offset: mMaxSize;
+    mCache = 0;
+    mCacheBits = 0;
+}
+
+bit_reader::bit_reader(const bit_ref & bitRef) {
+    const buf_val * buf = bitRef.Buf();
+    if ( buf && bitRef.IsLsbFirst() ) {
+        PDL_THROW( std::invalid_argument(
+            "bit_reader::bit_reader() LSB-first bits!"
+        ) );
+        buf = 0;
+    }
+    mData = buf? static_cast<const uint8_t *>( buf->Buf() ): 0;
+    mSize = mData? buf->Size(): 0;
+    mMaxSize = bit_ref::BitsOf(mSize);
+    mNextOffset = ( bitRef.Offset() < mMaxSize )? bitRef.Offset(): mMaxSize;
+    mCache = 0;
+    mCacheBits = 0;
+}
+
+void bit_reader::refill() {
+    while (mCacheBits <= 56 && mNextOffset < mMaxSize) {
+        buf_size_t idx = mNextOffset >> 3;
+        uint32_t shift = mNextOffset & 7;
+        uint64_t window = 0;
+        uint32_t n = 64 - shift; // the count of valid bits in the window.
+        if (idx + 8 <= mSize)
+            window = bit_kernel::LoadBE64(mData + idx) << shift;
+        else {
+            uint32_t m = static_cast<uint32_t>(mSize - idx);
+            for (uint32_t i = 0; i < m; ++i)
+                window |= uint64_t(mData[idx + i]) << ( 56 - (i << 3) );
+            window <<= shift;
+            n = (m << 3) - shift;
+        }
+        if (n > 64 - mCacheBits)
+            n = 64 - mCacheBits;
+        if (n > mMaxSize - mNextOffset)
+            n = static_cast<uint32_t>(mMaxSize - mNextOffset);
+        if (n < 64)
+            window &= ~( ~uint64_t(0) >> n );
+        mCache |= window >> mCacheBits;
+        mCacheBits += n;
+        mNextOffset += n;
+    }
+}
+
+void bit_reader::Seek(bit_size_t offset) {
+    if (offset > mMaxSize) {
+        PDL_THROW( std::overflow_error("bit_reader::Seek() overflow!") );
+        offset = mMaxSize;
+    }
+    mNextOffset = offset;
+    mCache = 0;
+    mCacheBits = 0;
+}
+
+void bit_writer::Flush() {
+    if (mCacheBits && mBuf) {
+        bit_size_t offset = mOffset;
+        uint32_t nbits = mCacheBits;
+        uint64_t bits = mCache >> (64 - mCacheBits);
+        mOffset += mCacheBits;
+        mCache = 0;
+        mCacheBits = 0;
+        if ( bit_ref::BitsOf( mBuf->Size() ) < mOffset )
+            mBuf->Resize( (mOffset >> 3) + ( (mOffset & 7)? 1: 0 ) );
+        bit_ref(mBuf, offset).WriteUInt(nbits, bits);
+    }
+}
+
+field_des::field_des() {
+    mFieldId = FIELD_ID_NONE;
+    mFinalizedDep = 0;
+    mIsDependency = false;
+    mParentFieldDes = 0;
+    mTreeNode = 0;
+}
+
+field_des::field_des(const field_des & src) {
+    mFieldId = FIELD_ID_NONE;
+    mFinalizedDep = 0;
+    mIsDependency = false;
+    mParentFieldDes = 0;
+    mTreeNode = src.mTreeNode;
+}
+
 bool field_des::IsSubField(
     const field_des * fieldDes, sub_idx * out_idx) const
 {
@@ -113,35 +510,89 @@ bool field_des::IsSubField(
     return false;
 }
 
+bool leaf_field_des::DecodeInt(bit_ref bitRef, uint64_t * out_val) const {
+    value_obj val;
+    if ( !out_val || !DecodeField(bitRef, &val) )
+        return false;
+    switch ( val.GetValType() ) {
+    case value_obj::BLN_VAL:
+        *out_val = val_itf_selector<bln_val>::GetInterface(&val)->Val();
+        return true;
+    case value_obj::INT_VAL:
+        *out_val = val_itf_selector<int_val>::GetInterface(&val)->Val();
+        return true;
+    case value_obj::INT64_VAL:
+        *out_val = val_itf_selector<int64_val>::GetInterface(&val)->Val();
+        return true;
+    }
+    return false;
+}
+
 bool field_info_generator::findDepFieldInfo(
     const field_des * depFieldDes, field_info_ctx * out_depFieldInfo)
 {
-    field_info_backtrace_buf::iterator itrEnd = mBacktraceBuf.end();
-    field_info_backtrace_buf::iterator itr = mBacktraceBuf.begin();
-    while (itr != itrEnd) {
-        if (depFieldDes == itr->mFieldDes) {
-            *out_depFieldInfo = *itr;
-            return true;
+    uint32_t slotId = depFieldDes->FieldId();
+    if (field_des::FIELD_ID_NONE == slotId) {
+        for (uint32_t i = 0; i < mBacktraceBuf.size(); ++i) {
+            if (depFieldDes == mBacktraceBuf[i].mFieldDes) {
+                *out_depFieldInfo = mBacktraceBuf[i];
+                return true;
+            }
         }
-        ++itr;
+        return false;
+    }
+    if ( slotId < mBacktraceSlots.size() && \
+         depFieldDes == mBacktraceSlots[slotId].mFieldDes && \
+         mBacktraceSlots[slotId].mFieldSize )
+    {
+        *out_depFieldInfo = mBacktraceSlots[slotId];
+        return true;
     }
     return false;
 }
 
+field_info_ctx * field_info_generator::backtraceSlot(
+    const field_des * fieldDes)
+{
+    uint32_t slotId = fieldDes->FieldId();
+    if (field_des::FIELD_ID_NONE == slotId) {
+        for (uint32_t i = 0; i < mBacktraceBuf.size(); ++i) {
+            if (fieldDes == mBacktraceBuf[i].mFieldDes)
+                return &(mBacktraceBuf[i]);
+        }
+        mBacktraceBuf.push_back( field_info_ctx() );
+        return &( mBacktraceBuf.back() );
+    }
+    if ( slotId >= mBacktraceSlots.size() )
+        mBacktraceSlots.resize(slotId + 1);
+    if (!mBacktraceSlots[slotId].mFieldDes)
+        mUsedSlotIds.push_back(slotId);
+    return &(mBacktraceSlots[slotId]);
+}
+
 uint32_t field_info_generator::getDepFieldInfo(
     const field_des_dependency * fieldDesDep,
     const field_des * fieldDes,
     const field_info_ctx ** out_depFieldInfo)
 {
-    uint32_t depFieldCount = fieldDesDep->FindWithB(fieldDes, 0); // get the count of dependent 'field_des'.
+    const field_des * const * depFieldDes = 0;
+    uint32_t depFieldCount = 0;
+    bool isDependency = false;
+    if ( !fieldDes->FinalizedDependency(
+            fieldDesDep, &depFieldDes, &depFieldCount, &isDependency ) )
+    {
+        depFieldCount = fieldDesDep->FindWithB(fieldDes, 0); // get the count of dependent 'field_des'.
+        if (depFieldCount) {
+            mDepFieldDesBuf.resize(depFieldCount);
+            fieldDesDep->FindWithB( fieldDes, &(mDepFieldDesBuf[0]) ); // get the dependent 'field_des' set.
+            depFieldDes = &(mDepFieldDesBuf[0]);
+        }
+    }
     if (depFieldCount) {
         bool found = false;
-        mDepFieldDesBuf.resize(depFieldCount);
-        fieldDesDep->FindWithB( fieldDes, &(mDepFieldDesBuf[0]) ); // get the dependent 'field_des' set.
         mDepFieldInfoBuf.resize(depFieldCount);
         for (uint32_t i = 0; i < depFieldCount; ++i) {
-            found = \
-                findDepFieldInfo( mDepFieldDesBuf[i], &(mDepFieldInfoBuf[i]) );
+            found = findDepFieldInfo( depFieldDes[i], &(mDepFieldInfoBuf[i]) );
             if (!found) {
                 PDL_THROW( std::runtime_error(
                     "field_info_generator::getDepFieldInfo()" \
@@ -159,90 +610,320 @@ uint32_t field_info_generator::getDepFieldInfo(
     return 0;
 }
 
-obj_ptr<field_info> field_info_generator::CreateFieldInfo(
-    const field_info_env & env, field_info_ctx * io_args)
+bool field_info_generator::CreateFieldInfoRange(
+    const field_info_env & env,
+    field_info_ctx * io_args,
+    field_info_range * out_range)
 {
-    if (io_args && env.mFieldDesDep && env.mBuf) {
+    if (io_args && out_range && env.mFieldDesDep && env.mBuf) {
         const field_info_ctx * depFieldInfo = 0;
         uint32_t depFieldInfoCount = getDepFieldInfo(
             env.mFieldDesDep, io_args->mFieldDes, &depFieldInfo
         );
+        bool lsbFirst = \
+            0 != ( io_args->mFieldDes->FieldOrder() & FIELD_ORDER_LSB_FIRST );
         io_args->mMaxFieldNum = io_args->mFieldDes->FieldCount(
-            bit_ref(env.mBuf, io_args->mFieldOffset),
+            bit_ref(env.mBuf, io_args->mFieldOffset, lsbFirst),
             depFieldInfo,
             depFieldInfoCount
         );
         if (io_args->mFieldNumber <= io_args->mMaxFieldNum) {
-            io_args->mFieldSize = io_args->mFieldDes->FieldSize(
-                bit_ref(env.mBuf, io_args->mFieldOffset),
-                depFieldInfo,
-                depFieldInfoCount
-            );
-            obj_constructor<field_info> fieldInfoConstructor(io_args);
-            obj_ptr<field_info> fieldInfo(
-                &fieldInfoConstructor,
-                io_args->mFieldDes->IsLeaf()? io_args->mMaxFieldNum: 1
-            );
-            for (uint32_t i = 1; i < fieldInfo->ItemCount(); ++i) {
-                fieldInfo[i].mCtx.mFieldNumber = i + 1;
-                fieldInfo[i].mCtx.mFieldOffset = \
-                    fieldInfo[i - 1].mCtx.mFieldOffset + \
-                    fieldInfo[i - 1].mCtx.mFieldSize;
-                fieldInfo[i].mCtx.mFieldSize = io_args->mFieldDes->FieldSize(
-                    bit_ref(env.mBuf, fieldInfo[i].mCtx.mFieldOffset),
+            bit_size_t constSize = io_args->mFieldDes->ConstFieldSize();
+            io_args->mFieldSize = constSize? constSize: \
+                io_args->mFieldDes->FieldSize(
+                    bit_ref(env.mBuf, io_args->mFieldOffset, lsbFirst),
                     depFieldInfo,
                     depFieldInfoCount
                 );
-            }
-            return fieldInfo;
+            out_range->mCount = \
+                io_args->mFieldDes->IsLeaf()? io_args->mMaxFieldNum: 1;
+            out_range->mConstSize = constSize;
+            out_range->mBuf = env.mBuf;
+            out_range->mLsbFirst = lsbFirst;
+            out_range->mDepFieldInfo = depFieldInfo;
+            out_range->mDepFieldInfoCount = depFieldInfoCount;
+            out_range->mCheckedEnd = mCheckedEnd;
+            io_args->mIsChecked = out_range->isChecked(*io_args);
+            out_range->mFirstItem = *io_args;
+            out_range->mCurItem = *io_args;
+            out_range->mCurIdx = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+obj_ptr<field_info> field_info_generator::CreateFieldInfo(
+    const field_info_range & range)
+{
+    if (0 == range.mCount)
+        return obj_ptr<field_info>();
+    obj_constructor<field_info> fieldInfoConstructor(&range.mFirstItem);
+    obj_ptr<field_info> fieldInfo(&fieldInfoConstructor, range.mCount);
+    if (range.mConstSize) {
+        bit_size_t offset = range.mFirstItem.mFieldOffset;
+        for (uint32_t i = 1; i < fieldInfo->ItemCount(); ++i) {
+            field_info_ctx & ctx = fieldInfo[i].mCtx;
+            ctx.mFieldNumber = i + 1;
+            ctx.mFieldOffset = offset + range.mConstSize * i;
         }
+        return fieldInfo;
+    }
+    for (uint32_t i = 1; i < fieldInfo->ItemCount(); ++i) {
+        fieldInfo[i].mCtx.mFieldNumber = i + 1;
+        fieldInfo[i].mCtx.mFieldOffset = \
+            fieldInfo[i - 1].mCtx.mFieldOffset + \
+            fieldInfo[i - 1].mCtx.mFieldSize;
+        fieldInfo[i].mCtx.mFieldSize = range.FieldDes()->FieldSize(
+            range.RefBits( range.mBuf, fieldInfo[i].mCtx ),
+            range.mDepFieldInfo,
+            range.mDepFieldInfoCount
+        );
+        fieldInfo[i].mCtx.mIsChecked = range.isChecked( fieldInfo[i].mCtx );
     }
+    return fieldInfo;
+}
+
+bool field_info_generator::CheckMessage(
+    const field_info_env & env, field_info_range * io_range)
+{
+    mCheckedEnd = 0;
+    if ( !env.mBuf || !io_range || 0 == io_range->mCount )
+        return false;
+    field_info_ctx & msg = io_range->mFirstItem;
+    bit_size_t maxSize = bit_ref::BitsOf( env.mBuf->Size() );
+    if ( msg.mFieldOffset > maxSize || \
+         msg.mFieldSize > maxSize - msg.mFieldOffset )
+        return false;
+    mCheckedEnd = msg.mFieldOffset + msg.mFieldSize;
+    io_range->mCheckedEnd = mCheckedEnd;
+    msg.mIsChecked = io_range->isChecked(msg);
+    io_range->mCurItem = msg;
+    io_range->mCurIdx = 0;
+    return true;
+}
+
+obj_ptr<field_info> field_info_generator::CreateFieldInfo(
+    const field_info_env & env, field_info_ctx * io_args)
+{
+    field_info_range range;
+    if ( CreateFieldInfoRange(env, io_args, &range) )
+        return CreateFieldInfo(range);
     return obj_ptr<field_info>();
 }
 
+bit_size_t field_info_generator::RefreshFieldSize(
+    const field_info_env & env,
+    obj_ptr<field_info> & fieldInfo,
+    bit_size_t defaultSize)
+{
+    if ( !fieldInfo || !fieldInfo->mCtx.mFieldDes || \
+         !env.mFieldDesDep || !env.mBuf )
+        return 0;
+    field_info_ctx & ctx = fieldInfo->mCtx;
+    const field_info_ctx * depFieldInfo = 0;
+    uint32_t depFieldInfoCount = getDepFieldInfo(
+        env.mFieldDesDep, ctx.mFieldDes, &depFieldInfo
+    );
+    bit_size_t fieldSize = ctx.mFieldDes->ConstFieldSize();
+    if (0 == fieldSize) {
+        fieldSize = ctx.mFieldDes->FieldSize(
+            bit_ref(
+                env.mBuf,
+                ctx.mFieldOffset,
+                0 != ( ctx.mFieldDes->FieldOrder() & FIELD_ORDER_LSB_FIRST )
+            ),
+            depFieldInfo,
+            depFieldInfoCount
+        );
+    }
+    ctx.mFieldSize = fieldSize? fieldSize: defaultSize;
+    ctx.mIsChecked = mCheckedEnd && ctx.mFieldOffset <= mCheckedEnd && \
+        ctx.mFieldSize <= mCheckedEnd - ctx.mFieldOffset;
+    return fieldSize;
+}
+
+void field_info_generator::PushBacktraceItem(
+    const obj_ptr<field_info> & fieldInfo, const buf_val * buf)
+{
+    if ( fieldInfo && fieldInfo->IsValid() )
+        PushBacktraceItem(fieldInfo->mCtx, buf);
+}
+
 void field_info_generator::PushBacktraceItem(
-    const obj_ptr<field_info> & fieldInfo)
-{
-    if ( fieldInfo && fieldInfo->IsValid() ) {
-        if ( gBacktraceItemPool.size() ) {
-            mBacktraceBuf.splice(
-                mBacktraceBuf.begin(),
-                gBacktraceItemPool,
-                gBacktraceItemPool.begin()
+    const field_info_ctx & fieldInfo, const buf_val * buf)
+{
+    if (fieldInfo.mFieldDes && fieldInfo.mFieldSize) {
+        field_info_ctx & slot = *backtraceSlot(fieldInfo.mFieldDes);
+        slot = fieldInfo; // the latest one replaces the previous one.
+        if ( buf && !slot.mIsDecoded && fieldInfo.mFieldDes->IsLeaf() ) {
+            const leaf_field_des * fieldDes = \
+                static_cast<const leaf_field_des *>(fieldInfo.mFieldDes);
+            slot.mIsDecoded = fieldDes->DecodeInt(
+                bit_ref(
+                    buf,
+                    slot.mFieldOffset,
+                    0 != ( fieldDes->FieldOrder() & FIELD_ORDER_LSB_FIRST )
+                ),
+                &(slot.mDecodedVal)
             );
-            mBacktraceBuf.front() = fieldInfo->mCtx;
-        } else
-            mBacktraceBuf.push_front(fieldInfo->mCtx);
+        }
+    }
+}
+
+void field_info_generator::CloseScope(
+    const field_des_dependency * fieldDesDep, const field_des * fieldDes)
+{
+    const field_des * const * scopedDepFieldDes = 0;
+    uint32_t scopedDepFieldCount = 0;
+    if ( !fieldDes->FinalizedScope(
+            fieldDesDep, &scopedDepFieldDes, &scopedDepFieldCount ) )
+        return;
+    for (uint32_t i = 0; i < scopedDepFieldCount; ++i) {
+        uint32_t slotId = scopedDepFieldDes[i]->FieldId();
+        if ( slotId < mBacktraceSlots.size() && \
+             scopedDepFieldDes[i] == mBacktraceSlots[slotId].mFieldDes )
+        {
+            // Keeps mFieldDes, so the slot id is not added to mUsedSlotIds
+            // again by the next item.
+            mBacktraceSlots[slotId].mFieldSize = 0;
+            mBacktraceSlots[slotId].mIsDecoded = false;
+        }
+    }
+}
+
+uint32_t field_info_generator::BacktraceItemCount() const {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < mUsedSlotIds.size(); ++i) {
+        if ( mBacktraceSlots[ mUsedSlotIds[i] ].mFieldSize )
+            ++count;
+    }
+    return count + static_cast<uint32_t>( mBacktraceBuf.size() );
+}
+
+bit_size_t field_info_range::EndOffset() const {
+    if (mConstSize)
+        return mFirstItem.mFieldOffset + mConstSize * mCount;
+    field_info_ctx lastItem;
+    if ( ItemAt(mCount - 1, &lastItem) )
+        return lastItem.mFieldOffset + lastItem.mFieldSize;
+    return mFirstItem.mFieldOffset;
+}
+
+bool field_info_range::ItemAt(uint32_t i, field_info_ctx * out_item) const {
+    if (i >= mCount || !out_item)
+        return false;
+    if (mConstSize) {
+        *out_item = mFirstItem;
+        out_item->mFieldNumber = i + 1;
+        out_item->mFieldOffset = mFirstItem.mFieldOffset + mConstSize * i;
+        return true;
     }
+    if (i < mCurIdx) { // restarts from the 1st. item.
+        mCurItem = mFirstItem;
+        mCurIdx = 0;
+    }
+    for (; mCurIdx < i; ++mCurIdx) {
+        mCurItem.mFieldNumber = mCurIdx + 2;
+        mCurItem.mFieldOffset += mCurItem.mFieldSize;
+        mCurItem.mFieldSize = FieldDes()->FieldSize(
+            RefBits(mBuf, mCurItem), mDepFieldInfo, mDepFieldInfoCount
+        );
+        mCurItem.mIsChecked = isChecked(mCurItem);
+    }
+    *out_item = mCurItem;
+    return true;
 }
 
 void field_info_generator::Reset() {
+    for (uint32_t i = 0; i < mUsedSlotIds.size(); ++i)
+        mBacktraceSlots[ mUsedSlotIds[i] ].mFieldDes = 0; // clear backtrace.
+    if ( mUsedSlotIds.size() )
+        mUsedSlotIds.resize(0);
     if ( mBacktraceBuf.size() )
-        gBacktraceItemPool.splice( gBacktraceItemPool.end(), mBacktraceBuf ); // clear backtrace.
+        mBacktraceBuf.resize(0);
     if ( mDepFieldDesBuf.size() )
         mDepFieldDesBuf.resize(0);
     if ( mDepFieldInfoBuf.size() )
         mDepFieldInfoBuf.resize(0);
+    mCheckedEnd = 0;
 }
 
-int combined_field_des::invokeCallback(
-    parse_callback * cb,
-    const field_info_env & env,
-    field_des_tree::stack_item * io_stackTop)
+bool sync_pattern::Match(const bit_ref & pos) const {
+    const buf_val * buf = pos.Buf();
+    if ( !buf || (pos.Offset() & 7) || !mBytes || 0 == mSize )
+        return false;
+    buf_size_t offset = buf_size_t(pos.Offset() >> 3);
+    return offset < buf->Size() && buf->Size() - offset >= mSize && \
+        0 == memcmp(
+            static_cast<const uint8_t *>( buf->Buf() ) + offset, mBytes, mSize
+        );
+}
+
+bit_size_t sync_pattern::Find(const bit_ref & pos) const {
+    bit_ref cur(pos);
+    bit_size_t maxSize = pos.MaxSize();
+    for (;;) {
+        bit_size_t offset = cur.FindBytes(mBytes, mSize);
+        if (offset >= maxSize)
+            return maxSize;
+        bool confirmed = true;
+        bit_size_t period = bit_ref::BitsOf(mPeriod);
+        for (uint32_t i = 1; mPeriod && confirmed && i <= mConfirmCount; ++i) {
+            bit_size_t next = offset + period * i;
+            if ( next >= maxSize || maxSize - next < bit_ref::BitsOf(mSize) )
+                break; // the periods beyond the buffer are not checked.
+            confirmed = Match( bit_ref(cur.Buf(), next) );
+        }
+        if (confirmed)
+            return offset;
+        cur = bit_ref(cur.Buf(), offset + 8);
+    }
+}
+
+int combined_field_des::parse_callback_invoker::onTraversal(
+    field_des_tree::stack_item * io_stackTop, int order)
 {
+    const field_info_env & env = mEnv;
     const field_des * fieldDes = io_stackTop->mTreeNode->GetValue();
     field_info_ctx args(
         fieldDes, mParseOffset, io_stackTop->mData.mFieldNumber + 1
     );
-    obj_ptr<field_info> fieldInfo = mFieldInfoGen.CreateFieldInfo(env, &args);
-    if (!fieldInfo)
+    field_info_range range;
+    if ( !mFieldInfoGen->CreateFieldInfoRange(env, &args, &range) )
         return 1; // refer tree::for_each_callback::onTraversal for the return value.
+    if (0 == mDepth) // the root, so the message range is checked once.
+        mFieldInfoGen->CheckMessage(env, &range);
     io_stackTop->mData.mMaxFieldNum = args.mMaxFieldNum;
-    int cbResult = cb->Callback(env, fieldInfo);
+    uint32_t lazyArrayThreshold = mCallback->LazyArrayThreshold();
+    bool lazyArray = fieldDes->IsLeaf() && lazyArrayThreshold && \
+        range.Count() >= lazyArrayThreshold;
+    obj_ptr<field_info> fieldInfo;
+    if (!lazyArray)
+        fieldInfo = mFieldInfoGen->CreateFieldInfo(range);
+    int cbResult = lazyArray? mCallback->ArrayCallback(env, range): \
+        mCallback->Callback(env, fieldInfo);
     if (cbResult >= 0) {
-        if ( env.mFieldDesDep->FindWithA(fieldDes, 0) ) // check if this is a dependent 'field_des'.
-            mFieldInfoGen.PushBacktraceItem(fieldInfo);
-        if ( fieldDes->IsLeaf() ) {
+        const field_des * const * depFieldDes = 0;
+        uint32_t depFieldCount = 0;
+        bool isDependency = false;
+        if ( !fieldDes->FinalizedDependency(
+                env.mFieldDesDep,
+                &depFieldDes,
+                &depFieldCount,
+                &isDependency ) )
+        {
+            isDependency = env.mFieldDesDep->FindWithA(fieldDes, 0) > 0; // check if this is a dependent 'field_des'.
+        }
+        if (isDependency) {
+            if (lazyArray)
+                mFieldInfoGen->PushBacktraceItem(args, env.mBuf);
+            else
+                mFieldInfoGen->PushBacktraceItem(fieldInfo, env.mBuf);
+        }
+        if (lazyArray)
+            mParseOffset = range.EndOffset();
+        else if ( fieldDes->IsLeaf() ) {
             const field_info & lastFieldInfo = \
                 fieldInfo[fieldInfo->ItemCount() - 1];
             mParseOffset = lastFieldInfo.Offset() + lastFieldInfo.SizeInBit();
@@ -251,35 +932,244 @@ int combined_field_des::invokeCallback(
     return cbResult;
 }
 
-int combined_field_des::ParseField(
-    parse_callback * cb, const field_info_env & env, uint32_t startOffset)
+// Collects the dependencies & the parent of each field in the tree.
+class combined_field_des::schema_finalizer:
+    public field_des_tree::for_each_callback
+{
+    typedef std_allocator<const field_des *,field_info> cp_field_des_allocator;
+    typedef std::vector<const field_des *,cp_field_des_allocator> field_des_buf;
+
+    const field_des_dependency * mFieldDesDep;
+    field_des_buf mParents; // the path from the root to the current field.
+
+public:
+    field_des_buf mFields; // the fields in pre-order.
+
+    explicit schema_finalizer(const field_des_dependency * fieldDesDep) {
+        mFieldDesDep = fieldDesDep;
+    }
+    virtual void onPushStack(field_des_tree::stack_item * io_stackTop) {
+        mParents.push_back( io_stackTop->mTreeNode->GetValue() );
+    }
+    virtual void afterPopStack(field_des_tree::stack_item * io_stackTop) {
+        mParents.pop_back();
+    }
+    virtual int onTraversal(
+        field_des_tree::stack_item * io_stackTop, int order)
+    {
+        const field_des * fieldDes = io_stackTop->mTreeNode->GetValue();
+        combined_field_des::finalizeField(
+            mFieldDesDep, fieldDes, mParents.size()? mParents.back(): 0
+        );
+        mFields.push_back(fieldDes);
+        return 0;
+    }
+};
+
+void combined_field_des::finalizeField(
+    const field_des_dependency * fieldDesDep,
+    const field_des * fieldDes,
+    const field_des * parentFieldDes)
+{
+    // The tree holds the const pointers, but the field_des is owned by the
+    // schema which is being finalized.
+    field_des * target = const_cast<field_des *>(fieldDes);
+    uint32_t depFieldCount = fieldDesDep->FindWithB(fieldDes, 0);
+    target->mDepFieldDes.resize(depFieldCount);
+    if (depFieldCount)
+        fieldDesDep->FindWithB( fieldDes, &(target->mDepFieldDes[0]) );
+    target->mIsDependency = fieldDesDep->FindWithA(fieldDes, 0) > 0;
+    target->mScopedDepFieldDes.resize(0);
+    target->mParentFieldDes = parentFieldDes;
+    target->mFinalizedDep = fieldDesDep;
+}
+
+// The scope of a dependency field is the nearest common ancestor (or itself)
+// of it & its dependents; a field out of the tree has no scope.
+void combined_field_des::finalizeScope(
+    const field_des_dependency * fieldDesDep, const field_des * fieldDes)
+{
+    if (!fieldDes->mIsDependency)
+        return;
+    uint32_t dependentCount = fieldDesDep->FindWithA(fieldDes, 0);
+    field_des_buf dependents(dependentCount);
+    fieldDesDep->FindWithA( fieldDes, &(dependents[0]) );
+    const field_des * scope = fieldDes;
+    for (uint32_t i = 0; scope && i < dependentCount; ++i) {
+        const field_des * common = 0;
+        if (dependents[i]->mFinalizedDep == fieldDesDep) {
+            for (const field_des * a = scope; a && !common; \
+                 a = a->mParentFieldDes)
+            {
+                for (const field_des * b = dependents[i]; b; \
+                     b = b->mParentFieldDes)
+                {
+                    if (a == b) {
+                        common = a;
+                        break;
+                    }
+                }
+            }
+        }
+        scope = common;
+    }
+    if (scope)
+        const_cast<field_des *>(scope)->mScopedDepFieldDes.push_back(fieldDes);
+}
+
+void combined_field_des::FinalizeSchema(
+    const field_des_dependency * fieldDesDep)
 {
-    if (cb && env.mFieldDesDep && env.mBuf) {
-        mParseOffset = startOffset;
-        parse_callback_invoker cbInvoker(this, cb, env);
+    if (fieldDesDep && mTreeNode) {
+        schema_finalizer finalizer(fieldDesDep);
         field_des_tree fieldDesTree(mTreeNode);
-        int cbResult = fieldDesTree.ForEach(&cbInvoker, 0);
+        fieldDesTree.ForEach(&finalizer, 0);
         *( fieldDesTree.GetRootNodeAddr() ) = 0; // to avoid delete.
-        mFieldInfoGen.Reset();
-        return cbResult;
+        for (uint32_t i = 0; i < finalizer.mFields.size(); ++i) {
+            // The fields of the tree are numbered in pre-order.
+            const_cast<field_des *>( finalizer.mFields[i] )->mFieldId = i;
+            finalizeScope(fieldDesDep, finalizer.mFields[i]);
+        }
+        return;
     }
     PDL_THROW( std::invalid_argument(
-        "combined_field_des::Parse() invalid argument!"
+        "combined_field_des::FinalizeSchema() invalid argument!"
     ) );
-    return (EINVAL < 0)? EINVAL: -EINVAL;
 }
 
-#define FIELD_DES_UT
-#ifdef FIELD_DES_UT
+int combined_field_des::parseField(
+    parse_callback * cb,
+    const field_info_env & env,
+    bit_size_t startOffset,
+    field_info_generator * fieldInfoGen,
+    bit_size_t * out_endOffset) const
+{
+    parse_callback_invoker cbInvoker(cb, env, fieldInfoGen, startOffset);
+    field_des_tree fieldDesTree(mTreeNode);
+    int cbResult = fieldDesTree.ForEach(&cbInvoker, 0);
+    *( fieldDesTree.GetRootNodeAddr() ) = 0; // to avoid delete.
+    fieldInfoGen->Reset();
+    if (out_endOffset)
+        *out_endOffset = cbInvoker.ParseOffset();
+    return cbResult;
+}
 
-#include <iostream>
-#include <fstream>
-#include "field_info_conv.h"
+int combined_field_des::ParseField(
+    parse_callback * cb,
+    const field_info_env & env,
+    bit_size_t startOffset,
+    field_info_generator * fieldInfoGen) const
+{
+    // The start of the message is checked here, and its whole range once the
+    // size of the root is known (see field_info_generator::CheckMessage()),
+    // so field_info::RefBits(buf, out_ref) checks nothing for the fields
+    // inside it.
+    if ( cb && env.mFieldDesDep && env.mBuf && \
+         startOffset <= bit_ref::BitsOf( env.mBuf->Size() ) )
+    {
+        if (fieldInfoGen)
+            return parseField(cb, env, startOffset, fieldInfoGen, 0);
+        field_info_generator tempFieldInfoGen;
+        return parseField(cb, env, startOffset, &tempFieldInfoGen, 0);
+    }
+    PDL_THROW( std::invalid_argument(
+        "combined_field_des::Parse() invalid argument!"
+    ) );
+    return (EINVAL < 0)? EINVAL: -EINVAL;
+}
 
-struct BITMAP {
-    int32_t bmType;
-    int32_t bmWidth;
-    int32_t bmHeigth;
+uint32_t combined_field_des::ParseStream(
+    parse_callback * cb,
+    const field_info_env & env,
+    const sync_pattern & sync,
+    bit_size_t startOffset,
+    field_info_generator * fieldInfoGen) const
+{
+    if ( !cb || !env.mFieldDesDep || !env.mBuf ) {
+        PDL_THROW( std::invalid_argument(
+            "combined_field_des::ParseStream() invalid argument!"
+        ) );
+        return 0;
+    }
+    field_info_generator tempFieldInfoGen;
+    if (!fieldInfoGen)
+        fieldInfoGen = &tempFieldInfoGen;
+    uint32_t msgCount = 0;
+    bit_size_t maxSize = bit_ref::BitsOf( env.mBuf->Size() );
+    bit_size_t offset = startOffset;
+    bit_size_t endOffset = 0;
+    while (offset < maxSize) {
+        bit_ref pos(env.mBuf, offset);
+        if ( sync.Match(pos) && \
+             parseField(cb, env, offset, fieldInfoGen, &endOffset) >= 0 && \
+             endOffset > offset && endOffset <= maxSize )
+        {
+            ++msgCount;
+            offset = endOffset;
+            continue;
+        }
+        // Skips the broken message by the next pattern after its 1st. byte.
+        bit_size_t syncOffset = sync.Find(
+            bit_ref( env.mBuf, ( (offset >> 3) + 1 ) << 3 )
+        );
+        if ( cb->OnResync(env, offset, syncOffset) < 0 )
+            break;
+        offset = syncOffset;
+    }
+    return msgCount;
+}
+
+uint32_t combined_field_des::ParseMany(
+    parse_callback * cb,
+    const field_info_env & env,
+    bit_size_t startOffset,
+    uint32_t maxMessages,
+    field_info_generator * fieldInfoGen,
+    bit_size_t * out_parsedSize) const
+{
+    if ( !cb || !env.mFieldDesDep || !env.mBuf || \
+         startOffset > bit_ref::BitsOf( env.mBuf->Size() ) )
+    {
+        PDL_THROW( std::invalid_argument(
+            "combined_field_des::ParseMany() invalid argument!"
+        ) );
+        return 0;
+    }
+    field_info_generator tempFieldInfoGen;
+    if (!fieldInfoGen)
+        fieldInfoGen = &tempFieldInfoGen;
+    parse_callback_invoker cbInvoker(cb, env, fieldInfoGen, startOffset);
+    field_des_tree fieldDesTree(mTreeNode);
+    uint32_t msgCount = 0;
+    bit_size_t maxSize = bit_ref::BitsOf( env.mBuf->Size() );
+    bit_size_t offset = startOffset;
+    while ( offset < maxSize && (0 == maxMessages || msgCount < maxMessages) )
+    {
+        cbInvoker.Restart(offset);
+        int cbResult = fieldDesTree.ForEach(&cbInvoker, 0);
+        fieldInfoGen->Reset();
+        bit_size_t endOffset = cbInvoker.ParseOffset();
+        if (cbResult < 0 || endOffset <= offset || endOffset > maxSize)
+            break;
+        ++msgCount;
+        offset = endOffset;
+    }
+    *( fieldDesTree.GetRootNodeAddr() ) = 0; // to avoid delete.
+    if (out_parsedSize)
+        *out_parsedSize = offset - startOffset;
+    return msgCount;
+}
+
+#ifdef FIELD_DES_UT
+
+#include <iostream>
+#include <fstream>
+#include "field_info_conv.h"
+
+struct BITMAP {
+    int32_t bmType;
+    int32_t bmWidth;
+    int32_t bmHeigth;
     int32_t bmWidthBytes;
     uint16_t bmPlanes;
     uint16_t bmBitsPixel;
@@ -300,22 +1190,36 @@ public:
     {
         return 1;
     }
-    virtual uint32_t FieldSize(
+    virtual bit_size_t FieldSize(
         bit_ref bitRef,
         const field_info_ctx * depFieldInfo,
         uint32_t depFieldInfoCount) const
     {
         return FIELD_SIZE;
     }
+    virtual bit_size_t ConstFieldSize() const {
+        return FIELD_SIZE;
+    }
     virtual bool DecodeField(bit_ref bitRef, value_obj * out_val) const;
     virtual bool EncodeField(bit_ref bitRef, const value_obj * val) const;
+    virtual bool DecodeInt(bit_ref bitRef, uint64_t * out_val) const {
+        unchecked_bit_ref bits;
+        if ( out_val && bitRef.Unchecked(FIELD_SIZE, &bits) ) {
+            *out_val = bits.ReadUInt( FIELD_SIZE, littleEndian() );
+            return true;
+        }
+        return false;
+    }
 
 private:
-    static void decVal(const uint8_t * data, value_obj * out_val, bool *) {
+    bool littleEndian() const {
+        return 0 != ( this->FieldOrder() & FIELD_ORDER_LITTLE_ENDIAN );
+    }
+    static void decVal(uint64_t data, value_obj * out_val, bool *) {
         val_itf_selector<bln_val>::GetInterface(out_val)->Val() = \
-            static_cast<bool>(*data);
+            static_cast<bool>(data);
     }
-    static bool encVal(const value_obj * val, uint8_t * out_data, bool *) {
+    static bool encVal(const value_obj * val, uint64_t * out_data, bool *) {
         const bln_val * blnVal = val_itf_selector<bln_val>::GetInterface(val);
         if (blnVal) {
             *out_data = blnVal->Val();
@@ -323,35 +1227,14 @@ private:
         }
         return false;
     }
-    static void decVal(const uint8_t * data, value_obj * out_val, uint16_t *) {
-        val_itf_selector<int_val>::GetInterface(out_val)->Val() = \
-            ( uint32_t(data[0]) << 8 ) | uint32_t(data[1]);
-    }
-    static bool encVal(const value_obj * val, uint8_t * out_data, uint16_t *) {
-        const int_val * intVal = val_itf_selector<int_val>::GetInterface(val);
-        if (intVal) {
-            uint32_t data = intVal->Val();
-            out_data[0] = uint8_t(data >> 8) & 0xff;
-            out_data[1] = uint8_t(data) & 0xff;
-            return true;
-        }
-        return false;
-    }
-    static void decVal(const uint8_t * data, value_obj * out_val, uint32_t *) {
+    static void decVal(uint64_t data, value_obj * out_val, void *) {
         val_itf_selector<int_val>::GetInterface(out_val)->Val() = \
-            ( uint32_t(data[0]) << 24 ) | \
-            ( uint32_t(data[1]) << 16 ) | \
-            ( uint32_t(data[2]) << 8 ) | \
-            uint32_t(data[3]);
+            static_cast<uint32_t>(data);
     }
-    static bool encVal(const value_obj * val, uint8_t * out_data, uint32_t *) {
+    static bool encVal(const value_obj * val, uint64_t * out_data, void *) {
         const int_val * intVal = val_itf_selector<int_val>::GetInterface(val);
         if (intVal) {
-            uint32_t data = intVal->Val();
-            out_data[0] = uint8_t(data >> 24) & 0xff;
-            out_data[1] = uint8_t(data >> 16) & 0xff;
-            out_data[2] = uint8_t(data >> 8) & 0xff;
-            out_data[3] = uint8_t(data) & 0xff;
+            *out_data = intVal->Val();
             return true;
         }
         return false;
@@ -361,12 +1244,16 @@ private:
 template <typename T>
 bool int_field<T>::DecodeField(bit_ref bitRef, value_obj * out_val) const {
     if ( bitRef.IsValid() && out_val ) {
-        uint8_t data[sizeof(T)];
         std::cout << "  <<< " << this->FieldName() << " [" << FIELD_SIZE << \
             " @" << bitRef.Offset() << "]: ";
-        if (  bitRef.ExportBits( FIELD_SIZE, data, sizeof(T) )  ) {
+        unchecked_bit_ref bits;
+        if ( bitRef.Unchecked(FIELD_SIZE, &bits) ) {
             out_val->Reset();
-            decVal( data, out_val, static_cast<T *>(0) );
+            decVal(
+                bits.ReadUInt( FIELD_SIZE, littleEndian() ),
+                out_val,
+                static_cast<T *>(0)
+            );
             if ( value_obj::BLN_VAL == out_val->GetValType() ) {
                 std::cout << \
                     val_itf_selector<bln_val>::GetInterface(out_val)->Val();
@@ -386,8 +1273,8 @@ bool int_field<T>::EncodeField(bit_ref bitRef, const value_obj * val) const {
     if ( bitRef.IsValid() && val ) {
         std::cout << "  " << this->FieldName() << " [" << FIELD_SIZE << \
             " @" << bitRef.Offset() << "]: <<< ";
-        uint8_t data[sizeof(T)];
-        if (  encVal( val, data, static_cast<T *>(0) )  ) {
+        uint64_t data = 0;
+        if (  encVal( val, &data, static_cast<T *>(0) )  ) {
             if ( value_obj::BLN_VAL == val->GetValType() ) {
                 std::cout << \
                     val_itf_selector<bln_val>::GetInterface(val)->Val();
@@ -396,9 +1283,8 @@ bool int_field<T>::EncodeField(bit_ref bitRef, const value_obj * val) const {
                     val_itf_selector<int_val>::GetInterface(val)->Val();
             }
             std::cout << std::endl;
-            return static_cast<bool>(
-                bitRef.ImportBits( FIELD_SIZE, data, sizeof(T) )
-            );
+            if ( FIELD_SIZE <= bitRef.MaxSize() - bitRef.Offset() )
+                return bitRef.WriteUInt( FIELD_SIZE, data, littleEndian() );
         }
     }
     return false;
@@ -459,18 +1345,13 @@ uint32_t bm_bits_field::FieldCount(
 {
     if ( bitRef.IsValid() && depFieldInfo && 2 == depFieldInfoCount ) {
         uint32_t fieldCount = 1;
-        int32_t imgSize;
-        value_obj fieldVal;
+        int64_t imgSize;
         for (uint32_t i = 0; i < 2; ++i) {
-            static_cast<const leaf_field_des *>(
-                depFieldInfo[i].mFieldDes
-            )->DecodeField(
-                bit_ref( bitRef.Buf(), depFieldInfo[i].mFieldOffset ),
-                &fieldVal
-            );
-            imgSize = static_cast<int32_t>(
-                val_itf_selector<int_val>::GetInterface(&fieldVal)->Val()
-            );
+            imgSize = depFieldInfo[i].mIsDecoded \
+                ? static_cast<int32_t>(depFieldInfo[i].mDecodedVal) \
+                : bit_ref(
+                    bitRef.Buf(), depFieldInfo[i].mFieldOffset
+                ).ReadInt(32);
             fieldCount *= (imgSize < 0)? -imgSize: imgSize;
         }
         return fieldCount;
@@ -490,7 +1371,7 @@ public:
     {
         return 1;
     }
-    virtual uint32_t FieldSize(
+    virtual bit_size_t FieldSize(
         bit_ref bitRef,
         const field_info_ctx * depFieldInfo,
         uint32_t depFieldInfoCount) const
@@ -531,6 +1412,108 @@ struct bm_parser_callback: combined_field_des::parse_callback {
     }
 };
 
+struct bm_size_callback: combined_field_des::parse_callback {
+    uint32_t mFieldCount;
+    bit_size_t mLeafBits;
+
+    bm_size_callback() {
+        mFieldCount = 0;
+        mLeafBits = 0;
+    }
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        uint32_t n = fieldInfo->ItemCount();
+        mFieldCount += n;
+        if ( fieldInfo->FieldDes()->IsLeaf() ) {
+            for (uint32_t i = 0; i < n; ++i)
+                mLeafBits += fieldInfo[i].SizeInBit();
+        }
+        return 0;
+    }
+};
+
+// Counts like bm_size_callback, but gets the arrays as the lazy views.
+struct bm_range_callback: bm_size_callback {
+    bool mMatched;
+
+    bm_range_callback() {
+        mMatched = true;
+    }
+    virtual uint32_t LazyArrayThreshold() const {
+        return 2;
+    }
+    virtual int ArrayCallback(
+        const field_info_env & env, const field_info_range & range)
+    {
+        uint32_t n = range.Count();
+        mFieldCount += n;
+        field_info_ctx item;
+        for (uint32_t i = 0; i < n && range.ItemAt(i, &item); ++i)
+            mLeafBits += item.mFieldSize;
+        std::vector<uint16_t> bits(n);
+        mMatched = mMatched && \
+            range.DecodeArray( env.mBuf, &(bits[0]), n ) == n && \
+            range.ItemAt(n - 1, &item) && \
+            range.RefBits(env.mBuf, item).ReadUInt(16) == bits[n - 1] && \
+            range.EndOffset() == item.mFieldOffset + item.mFieldSize;
+        return 0;
+    }
+};
+
+// Compares the bulk decoded bm_bits with the items decoded one by one.
+struct bm_bits_callback: combined_field_des::parse_callback {
+    uint32_t mBitsCount;
+    bool mMatched;
+
+    bm_bits_callback() {
+        mBitsCount = 0;
+        mMatched = false;
+    }
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        if ( 0 == strcmp( "bm_bits", fieldInfo->FieldDes()->FieldName() ) ) {
+            uint32_t n = fieldInfo->ItemCount();
+            std::vector<uint16_t> bits(n);
+            mBitsCount = fieldInfo->DecodeArray( env.mBuf, &(bits[0]), n );
+            mMatched = (mBitsCount == n);
+            for (uint32_t i = 0; mMatched && i < n; ++i) {
+                mMatched = \
+                    fieldInfo[i].RefBits(env.mBuf).ReadUInt(16) == bits[i];
+            }
+        }
+        return 0;
+    }
+};
+
+// Counts the items inside the message range checked by the parsing, and reads
+// them by the unchecked_bit_ref.
+struct bm_checked_callback: bm_size_callback {
+    uint32_t mCheckedCount;
+    bool mMatched;
+
+    bm_checked_callback() {
+        mCheckedCount = 0;
+        mMatched = true;
+    }
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        bm_size_callback::Callback(env, fieldInfo);
+        for (uint32_t i = 0; i < fieldInfo->ItemCount(); ++i) {
+            if ( !fieldInfo[i].IsChecked() )
+                continue;
+            ++mCheckedCount;
+            unchecked_bit_ref bits;
+            mMatched = mMatched && \
+                fieldInfo[i].RefBits(env.mBuf, &bits) && \
+                bits.ReadUInt(8) == fieldInfo[i].RefBits(env.mBuf).ReadUInt(8);
+        }
+        return 0;
+    }
+};
+
 bitmap_field BITMAP_FIELD;
 bm_type_field BM_TYPE_FIELD;
 bm_width_field BM_WIDTH_FIELD;
@@ -551,6 +1534,673 @@ field_des * BM_FIELD_DES[8] = {
     &BM_BITS_FIELD
 };
 
+// The bit-by-bit implementation which bit_ref::copyBits() should match.
+static uint32_t refCopyBits(
+    const uint8_t * src,
+    uint32_t srcSize,
+    uint32_t srcOffset,
+    uint8_t * dst,
+    uint32_t dstSize,
+    uint32_t dstOffset,
+    uint32_t length)
+{
+    if ( length && srcOffset < (srcSize << 3) && dstOffset < (dstSize << 3) ) {
+        if (length > (srcSize << 3) - srcOffset)
+            length = (srcSize << 3) - srcOffset;
+        if (length > (dstSize << 3) - dstOffset)
+            length = (dstSize << 3) - dstOffset;
+        for (uint32_t i = 0; i < length; ++i) {
+            uint32_t s = srcOffset + i, d = dstOffset + i;
+            uint8_t dstMask = uint8_t(1) << ( 7 - (d & 7) );
+            if ( src[s >> 3] & ( uint8_t(1) << ( 7 - (s & 7) ) ) )
+                dst[d >> 3] |= dstMask;
+            else
+                dst[d >> 3] &= ~dstMask;
+        }
+        return length;
+    }
+    return 0;
+}
+
+static bool testCopyBits() {
+    const uint32_t BUF_SIZE = 24;
+    const uint32_t MAX_BITS = BUF_SIZE << 3;
+    uint8_t srcBuf[BUF_SIZE], dstInit[BUF_SIZE];
+    uint8_t dstBuf[BUF_SIZE], refBuf[BUF_SIZE];
+    uint32_t seed = 0x12345678;
+    for (uint32_t i = 0; i < BUF_SIZE; ++i) {
+        seed = seed * 1103515245 + 12345;
+        srcBuf[i] = uint8_t(seed >> 16);
+        seed = seed * 1103515245 + 12345;
+        dstInit[i] = uint8_t(seed >> 16);
+    }
+    value_obj srcObj;
+    buf_val * srcVal = val_itf_selector<buf_val>::GetInterface(&srcObj);
+    srcVal->Resize(BUF_SIZE);
+    memcpy(srcVal->Buf(), srcBuf, BUF_SIZE);
+    for (uint32_t s = 0; s < MAX_BITS; ++s) {
+        bit_ref srcRef(srcVal, s);
+        for (uint32_t d = 0; d < MAX_BITS; ++d) {
+            for (uint32_t l = 1; l <= MAX_BITS; ++l) {
+                memcpy(dstBuf, dstInit, BUF_SIZE);
+                memcpy(refBuf, dstInit, BUF_SIZE);
+                uint32_t n = srcRef.ExportBits(l, dstBuf, BUF_SIZE, d);
+                uint32_t m = refCopyBits(
+                    srcBuf, BUF_SIZE, s, refBuf, BUF_SIZE, d, l
+                );
+                if ( n != m || memcmp(dstBuf, refBuf, BUF_SIZE) ) {
+                    std::cout << "bit_ref::copyBits() failed: src @" << s << \
+                        ", dst @" << d << ", length " << l << std::endl;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+static bool testIntBits() {
+    const uint32_t BUF_SIZE = 24;
+    uint8_t bitsBuf[BUF_SIZE], refBuf[BUF_SIZE];
+    value_obj intObj;
+    buf_val * intVal = val_itf_selector<buf_val>::GetInterface(&intObj);
+    intVal->Resize(BUF_SIZE);
+    uint64_t val = 0x0123456789abcdefULL;
+    for (uint32_t offset = 0; offset < (BUF_SIZE << 3); ++offset) {
+        bit_ref intRef(intVal, offset);
+        for (uint32_t nbits = 1; nbits <= 64; ++nbits) {
+            if ( nbits > (BUF_SIZE << 3) - offset )
+                break;
+            val = val * 6364136223846793005ULL + 1442695040888963407ULL;
+            memset(intVal->Buf(), 0x5a, BUF_SIZE);
+            intRef.WriteUInt(nbits, val);
+            // refer the bit-by-bit copy for the expected result.
+            memset(refBuf, 0x5a, BUF_SIZE);
+            for (uint32_t i = 0; i < 8; ++i)
+                bitsBuf[i] = uint8_t( (val << (64 - nbits)) >> (56 - i * 8) );
+            refCopyBits(bitsBuf, 8, 0, refBuf, BUF_SIZE, offset, nbits);
+            uint64_t mask = ~uint64_t(0) >> (64 - nbits);
+            if ( memcmp(intVal->Buf(), refBuf, BUF_SIZE) || \
+                intRef.ReadUInt(nbits) != (val & mask) )
+            {
+                std::cout << "bit_ref::WriteUInt()/ReadUInt() failed: @" << \
+                    offset << ", size " << nbits << std::endl;
+                return false;
+            }
+            uint64_t sval = val & mask;
+            if ( nbits < 64 && ( sval >> (nbits - 1) ) )
+                sval |= ~mask;
+            if ( intRef.ReadInt(nbits) != static_cast<int64_t>(sval) ) {
+                std::cout << "bit_ref::ReadInt() failed: @" << \
+                    offset << ", size " << nbits << std::endl;
+                return false;
+            }
+            unchecked_bit_ref uncheckedRef;
+            if ( !intRef.Unchecked(nbits, &uncheckedRef) || \
+                 uncheckedRef.ReadInt(nbits) != static_cast<int64_t>(sval) )
+            {
+                std::cout << "unchecked_bit_ref::ReadInt() failed: @" << \
+                    offset << ", size " << nbits << std::endl;
+                return false;
+            }
+            if (  (nbits <= 8 || 0 == (nbits & 7)) && \
+                ( !intRef.WriteUInt(nbits, val, true) || \
+                  intRef.ReadUInt(nbits, true) != (val & mask) )  )
+            {
+                std::cout << "bit_ref::ReadUInt() little-endian failed: @" << \
+                    offset << ", size " << nbits << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool lsbBit(const uint8_t * data, uint32_t offset) {
+    return ( data[offset >> 3] >> (offset & 7) ) & 1;
+}
+
+static bool testBitOrder() {
+    const uint32_t BUF_SIZE = 24;
+    uint8_t refBuf[BUF_SIZE];
+    value_obj bitsObj, copyObj;
+    buf_val * bitsVal = val_itf_selector<buf_val>::GetInterface(&bitsObj);
+    buf_val * copyVal = val_itf_selector<buf_val>::GetInterface(&copyObj);
+    bitsVal->Resize(BUF_SIZE);
+    copyVal->Resize(BUF_SIZE);
+    uint8_t * bits = static_cast<uint8_t *>( bitsVal->Buf() );
+    uint64_t val = 0xfedcba9876543210ULL;
+    for (uint32_t offset = 0; offset < (BUF_SIZE << 3); ++offset) {
+        bit_ref lsbRef(bitsVal, offset, true);
+        for (uint32_t nbits = 1; nbits <= 64; ++nbits) {
+            if ( nbits > (BUF_SIZE << 3) - offset )
+                break;
+            val = val * 6364136223846793005ULL + 1442695040888963407ULL;
+            for (uint32_t i = 0; i < BUF_SIZE; ++i)
+                bits[i] = uint8_t(val >> (i & 31)) ^ uint8_t(i * 37);
+            memcpy(refBuf, bits, BUF_SIZE);
+            // the 1st. bit is the LSB of both the byte & the integer.
+            uint64_t expected = 0;
+            for (uint32_t i = 0; i < nbits; ++i)
+                expected |= uint64_t( lsbBit(bits, offset + i) ) << i;
+            if ( lsbRef.ReadUInt(nbits, true) != expected ) {
+                std::cout << "LSB-first bit_ref::ReadUInt() failed: @" << \
+                    offset << ", size " << nbits << std::endl;
+                return false;
+            }
+            uint64_t bigEndian = (nbits <= 8)? expected: \
+                ( bit_kernel::ByteSwap64(expected) >> (64 - nbits) );
+            if ( (nbits <= 8 || 0 == (nbits & 7)) && \
+                 lsbRef.ReadUInt(nbits) != bigEndian )
+            {
+                std::cout << "LSB-first bit_ref::ReadUInt() big-endian " \
+                    "failed: @" << offset << ", size " << nbits << std::endl;
+                return false;
+            }
+            lsbRef.WriteUInt(nbits, ~expected, true);
+            bool matched = true;
+            for (uint32_t i = 0; matched && i < (BUF_SIZE << 3); ++i) {
+                bool inside = (i >= offset && i < offset + nbits);
+                matched = ( lsbBit(bits, i) == \
+                    (inside? !lsbBit(refBuf, i): lsbBit(refBuf, i)) );
+            }
+            // export the bits to another offset in the same bit order.
+            uint32_t dstOffset = (offset * 7 + nbits) % 13;
+            memset(copyVal->Buf(), 0, BUF_SIZE);
+            lsbRef.ExportBits(nbits, copyVal, dstOffset);
+            for (uint32_t i = 0; matched && i < nbits; ++i) {
+                matched = lsbBit(bits, offset + i) == lsbBit(
+                    static_cast<uint8_t *>( copyVal->Buf() ), dstOffset + i
+                );
+            }
+            if (!matched) {
+                std::cout << "LSB-first bit_ref::WriteUInt()/ExportBits() " \
+                    "failed: @" << offset << ", size " << nbits << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool testBitStream() {
+    const uint32_t BUF_SIZE = 256;
+    value_obj srcObj, dstObj;
+    buf_val * srcVal = val_itf_selector<buf_val>::GetInterface(&srcObj);
+    buf_val * dstVal = val_itf_selector<buf_val>::GetInterface(&dstObj);
+    srcVal->Resize(BUF_SIZE);
+    uint32_t seed = 0x2468ace0;
+    for (uint32_t i = 0; i < BUF_SIZE; ++i) {
+        seed = seed * 1103515245 + 12345;
+        static_cast<uint8_t *>( srcVal->Buf() )[i] = uint8_t(seed >> 16);
+    }
+    for (uint32_t start = 0; start < 16; ++start) {
+        bit_reader reader( bit_ref(srcVal, start) );
+        dstVal->Resize(0);
+        bit_writer writer(dstVal, start);
+        bit_size_t offset = start;
+        uint32_t nbits = 0;
+        while ( reader.RemainedBits() ) {
+            seed = seed * 1103515245 + 12345;
+            nbits = (seed >> 16) % 64 + 1;
+            if ( nbits > reader.RemainedBits() )
+                nbits = reader.RemainedBits();
+            uint64_t val = bit_ref(srcVal, offset).ReadUInt(nbits);
+            if ( ( (seed >> 8) & 1 ) && nbits <= 57 && \
+                reader.Peek(nbits) != val )
+            {
+                break;
+            }
+            if ( reader.Read(nbits) != val )
+                break;
+            writer.Write(nbits, val);
+            offset += nbits;
+        }
+        writer.Flush();
+        if ( reader.Offset() != bit_ref::BitsOf(BUF_SIZE) || \
+            writer.Offset() != reader.Offset() || \
+            dstVal->Size() != BUF_SIZE || \
+            memcmp( static_cast<uint8_t *>( dstVal->Buf() ) + 2, \
+                static_cast<uint8_t *>( srcVal->Buf() ) + 2, BUF_SIZE - 2 ) )
+        {
+            std::cout << "bit_reader/bit_writer failed: @" << start << \
+                ", offset " << offset << std::endl;
+            return false;
+        }
+    }
+
+    // The writing to a read-only buffer fails, and the destructor doesn't
+    // throw again when the exception unwinds the stack.
+    std::vector<uint8_t> srcData(
+        static_cast<const uint8_t *>( srcVal->Buf() ),
+        static_cast<const uint8_t *>( srcVal->Buf() ) + BUF_SIZE
+    );
+    buf_val roVal;
+    roVal.Attach( static_cast<const void *>( &(srcData[0]) ), BUF_SIZE );
+    bool rejected = false;
+#ifdef DISABLE_RTTI
+    {
+        bit_writer writer(&roVal);
+        for (uint32_t i = 0; i < 4; ++i)
+            writer.Write(32, 0);
+    }
+    rejected = true;
+#else
+    try {
+        bit_writer writer(&roVal);
+        for (uint32_t i = 0; i < 4; ++i)
+            writer.Write(32, 0);
+    } catch (const std::runtime_error &) {
+        rejected = true;
+    }
+#endif
+    if ( !rejected || memcmp( &(srcData[0]), srcVal->Buf(), BUF_SIZE ) ) {
+        std::cout << "read-only bit_writer failed." << std::endl;
+        return false;
+    }
+
+    // The LSB-first bits are rejected.
+    bit_size_t lsbMaxSize = 0;
+#ifdef DISABLE_RTTI
+    lsbMaxSize = bit_reader( bit_ref(srcVal, 0, true) ).MaxSize();
+#else
+    try {
+        lsbMaxSize = bit_reader( bit_ref(srcVal, 0, true) ).MaxSize();
+    } catch (const std::invalid_argument &) {
+        lsbMaxSize = 0;
+    }
+#endif
+    if (lsbMaxSize) {
+        std::cout << "LSB-first bit_reader failed." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+class ts_sync_field: public int_field<uint8_t> {
+    virtual const char * FieldName() const {
+        return "ts_sync";
+    }
+};
+
+class ts_payload_field: public int_field<uint8_t> {
+    virtual const char * FieldName() const {
+        return "ts_payload";
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 187;
+    }
+};
+
+class ts_packet_field: public combined_field_des {
+public:
+    virtual const char * FieldName() const {
+        return "ts_packet";
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 1;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 188 << 3;
+    }
+};
+
+// Rejects the packets with the 1st. payload byte 0xff (as a transport error).
+struct ts_stream_callback: combined_field_des::parse_callback {
+    uint32_t mResyncCount;
+
+    ts_stream_callback() {
+        mResyncCount = 0;
+    }
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        if ( 0 == strcmp( "ts_payload", fieldInfo->FieldDes()->FieldName() ) )
+            return ( fieldInfo->RefBits(env.mBuf).ReadUInt(8) == 0xff )? -1: 1;
+        return 0;
+    }
+    virtual int OnResync(
+        const field_info_env & env,
+        bit_size_t failedOffset,
+        bit_size_t syncOffset)
+    {
+        ++mResyncCount;
+        return 0;
+    }
+};
+
+static bool testSyncStream() {
+    // 7 packets, the 37 bytes garbage (with fake sync bytes) after the 3rd.
+    // one, and the 4th. one is broken.
+    const uint32_t PACKET_SIZE = 188;
+    const uint32_t GARBAGE_SIZE = 37;
+    const uint8_t SYNC_BYTE = 0x47;
+    value_obj streamObj;
+    buf_val * stream = val_itf_selector<buf_val>::GetInterface(&streamObj);
+    stream->Resize(PACKET_SIZE * 7 + GARBAGE_SIZE);
+    uint8_t * data = static_cast<uint8_t *>( stream->Buf() );
+    for (uint32_t i = 0, pos = 0; i < 7; ++i) {
+        if (3 == i) {
+            for (uint32_t j = 0; j < GARBAGE_SIZE; ++j)
+                data[pos++] = (j % 5 == 2)? SYNC_BYTE: uint8_t(j * 13);
+        }
+        data[pos++] = SYNC_BYTE;
+        for (uint32_t j = 1; j < PACKET_SIZE; ++j, ++pos)
+            data[pos] = (3 == i && 1 == j)? 0xff: uint8_t(j & 0x3f);
+    }
+
+    bit_size_t maxSize = bit_ref::BitsOf( stream->Size() );
+    for (uint32_t start = 0; start < 64; start += 3) {
+        bit_size_t expected = start;
+        while ( expected + 8 <= maxSize && \
+            bit_ref(stream, expected).ReadUInt(8) != SYNC_BYTE )
+        {
+            ++expected;
+        }
+        if ( bit_ref(stream, start).FindBits(SYNC_BYTE, 8) != expected ) {
+            std::cout << "bit_ref::FindBits() failed: @" << start << std::endl;
+            return false;
+        }
+    }
+    if ( bit_ref(stream, 1).FindBytes(&SYNC_BYTE, 1) != \
+        bit_ref::BitsOf(PACKET_SIZE) )
+    {
+        std::cout << "bit_ref::FindBytes() failed." << std::endl;
+        return false;
+    }
+
+    ts_sync_field tsSync;
+    ts_payload_field tsPayload;
+    ts_packet_field tsPacket;
+    field_des_tree::node_ptr packetNode = field_des_tree::CreateNode(&tsPacket);
+    tsPacket.BindTreeNode(packetNode);
+    packetNode->SetSubNodeCapacity(2);
+    field_des_tree::node_ptr subNode = field_des_tree::CreateNode(&tsSync);
+    tsSync.BindTreeNode(subNode);
+    packetNode->SetSubNode(0, subNode);
+    subNode = field_des_tree::CreateNode(&tsPayload);
+    tsPayload.BindTreeNode(subNode);
+    packetNode->SetSubNode(1, subNode);
+    field_des_tree packetTree(packetNode); // to delete nodes.
+
+    field_des_dependency tsFieldDesDep;
+    field_info_env tsEnv = {&tsFieldDesDep, stream};
+    sync_pattern sync = {&SYNC_BYTE, 1, PACKET_SIZE, 2};
+    ts_stream_callback cb;
+    uint32_t packetCount = tsPacket.ParseStream(&cb, tsEnv, sync);
+    if (packetCount != 6 || cb.mResyncCount != 2) {
+        std::cout << "combined_field_des::ParseStream() failed: " << \
+            packetCount << " packets, " << cb.mResyncCount << " resyncs." << \
+            std::endl;
+        return false;
+    }
+    return true;
+}
+
+class rec_len_field: public int_field<uint8_t> {
+    virtual const char * FieldName() const {
+        return "rec_len";
+    }
+};
+
+class rec_data_field: public int_field<uint8_t> {
+    virtual const char * FieldName() const {
+        return "rec_data";
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return (1 == depFieldInfoCount && depFieldInfo[0].mIsDecoded) \
+            ? static_cast<uint32_t>(depFieldInfo[0].mDecodedVal): 0;
+    }
+};
+
+template <uint32_t N>
+class rec_list_field: public combined_field_des {
+public:
+    virtual const char * FieldName() const {
+        return "rec_list";
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return N;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return bitRef.MaxSize() - bitRef.Offset();
+    }
+};
+
+// Checks the backtrace holds the rec_len of the current record only.
+struct rec_list_callback: combined_field_des::parse_callback {
+    const field_info_generator * mFieldInfoGen;
+    uint32_t mDataCount;
+    bool mMatched;
+
+    explicit rec_list_callback(const field_info_generator * fieldInfoGen) {
+        mFieldInfoGen = fieldInfoGen;
+        mDataCount = 0;
+        mMatched = true;
+    }
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        const char * fieldDesName = fieldInfo->FieldDes()->FieldName();
+        if ( 0 == strcmp("rec_len", fieldDesName) )
+            mMatched = mMatched && 0 == mFieldInfoGen->BacktraceItemCount();
+        else if ( 0 == strcmp("rec_data", fieldDesName) ) {
+            mMatched = mMatched && 1 == mFieldInfoGen->BacktraceItemCount();
+            mDataCount += fieldInfo->ItemCount();
+        }
+        return 0;
+    }
+};
+
+// The buffer of 100 records of (len, data[len]) with len = 1 ~ 5, and the
+// schema of a record of N items; the test puts mRecNode into its tree.
+static const uint32_t REC_COUNT = 100;
+
+template <uint32_t N>
+struct rec_schema {
+    rec_len_field mRecLen;
+    rec_data_field mRecData;
+    rec_list_field<N> mRec;
+    field_des_tree::node_ptr mRecNode;
+    field_des_dependency mFieldDesDep;
+    value_obj mListObj;
+    buf_size_t mSize;
+    uint32_t mDataCount;
+
+    rec_schema() {
+        std::vector<uint8_t> data;
+        mDataCount = 0;
+        for (uint32_t i = 0; i < REC_COUNT; ++i) {
+            uint8_t len = uint8_t(i % 5 + 1);
+            data.push_back(len);
+            data.insert(data.end(), len, uint8_t(i));
+            mDataCount += len;
+        }
+        mSize = data.size();
+        buf_val * list = val_itf_selector<buf_val>::GetInterface(&mListObj);
+        list->Resize(mSize);
+        memcpy( list->Buf(), &(data[0]), mSize );
+
+        mRecNode = field_des_tree::CreateNode(&mRec);
+        mRec.BindTreeNode(mRecNode);
+        mRecNode->SetSubNodeCapacity(2);
+        field_des_tree::node_ptr subNode = field_des_tree::CreateNode(&mRecLen);
+        mRecLen.BindTreeNode(subNode);
+        mRecNode->SetSubNode(0, subNode);
+        subNode = field_des_tree::CreateNode(&mRecData);
+        mRecData.BindTreeNode(subNode);
+        mRecNode->SetSubNode(1, subNode);
+        mFieldDesDep.Insert(&mRecLen, &mRecData);
+    }
+    field_info_env Env() {
+        field_info_env env = {
+            &mFieldDesDep, val_itf_selector<buf_val>::GetInterface(&mListObj)
+        };
+        return env;
+    }
+};
+
+static bool testBacktraceScope() {
+    // A list of all the records.
+    rec_schema<REC_COUNT> schema;
+    rec_list_field<1> recList;
+    field_des_tree::node_ptr listNode = field_des_tree::CreateNode(&recList);
+    recList.BindTreeNode(listNode);
+    listNode->SetSubNodeCapacity(1);
+    listNode->SetSubNode(0, schema.mRecNode);
+    field_des_tree listTree(listNode); // to delete nodes.
+
+    recList.FinalizeSchema(&schema.mFieldDesDep);
+    field_info_generator fieldInfoGen;
+    rec_list_callback cb(&fieldInfoGen);
+    recList.ParseField(&cb, schema.Env(), 0, &fieldInfoGen);
+    if (!cb.mMatched || cb.mDataCount != schema.mDataCount) {
+        std::cout << "field_info_generator::CloseScope() failed: " << \
+            cb.mDataCount << " items." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool testParseMany() {
+    // Each record is a message, the first 10 ones are parsed, then the rest.
+    rec_schema<1> schema;
+    field_des_tree msgTree(schema.mRecNode); // to delete nodes.
+
+    schema.mRec.FinalizeSchema(&schema.mFieldDesDep);
+    field_info_env msgEnv = schema.Env();
+    field_info_generator fieldInfoGen;
+    rec_list_callback msgCb(&fieldInfoGen);
+    bit_size_t parsedSize = 0;
+    uint32_t msgCount = schema.mRec.ParseMany(
+        &msgCb, msgEnv, 0, 10, &fieldInfoGen, &parsedSize
+    );
+    bit_size_t headSize = parsedSize;
+    msgCount += schema.mRec.ParseMany(
+        &msgCb, msgEnv, headSize, 0, &fieldInfoGen, &parsedSize
+    );
+    if ( msgCount != REC_COUNT || \
+         headSize != bit_ref::BitsOf(10 + 30) || \
+         headSize + parsedSize != bit_ref::BitsOf(schema.mSize) || \
+         !msgCb.mMatched || msgCb.mDataCount != schema.mDataCount )
+    {
+        std::cout << "combined_field_des::ParseMany() failed: " << \
+            msgCount << " messages." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// The items of 1 ~ 3 bytes, the size (in byte) is in the first byte.
+class var_item_field: public int_field<uint16_t> {
+    virtual const char * FieldName() const {
+        return "var_item";
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 4;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return bit_ref::BitsOf( bitRef.ReadUInt(8) );
+    }
+    virtual bit_size_t ConstFieldSize() const {
+        return 0;
+    }
+};
+
+struct var_item_callback: combined_field_des::parse_callback {
+    uint32_t mItemCount;
+    uint32_t mDecodedCount;
+
+    var_item_callback() {
+        mItemCount = 0;
+        mDecodedCount = 0;
+    }
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        if ( 0 == strcmp( "var_item", fieldInfo->FieldDes()->FieldName() ) ) {
+            uint16_t vals[4];
+            mItemCount = fieldInfo->ItemCount();
+            mDecodedCount = fieldInfo->DecodeArray(env.mBuf, vals, 4);
+        }
+        return 0;
+    }
+};
+
+static bool testVarDecodeArray() {
+    // 16, 8, 24 & 16 bits: the last item is where a 16-bit array puts it.
+    uint8_t data[] = {2, 0, 1, 3, 0, 0, 2, 0};
+    var_item_field varItem;
+    rec_list_field<1> varList;
+    field_des_tree::node_ptr listNode = field_des_tree::CreateNode(&varList);
+    varList.BindTreeNode(listNode);
+    listNode->SetSubNodeCapacity(1);
+    field_des_tree::node_ptr subNode = field_des_tree::CreateNode(&varItem);
+    varItem.BindTreeNode(subNode);
+    listNode->SetSubNode(0, subNode);
+    field_des_tree listTree(listNode); // to delete nodes.
+
+    field_des_dependency varFieldDesDep;
+    field_info_span_env varEnv( &varFieldDesDep, data, sizeof(data) );
+    var_item_callback cb;
+    varList.ParseField(&cb, varEnv);
+    if (4 != cb.mItemCount || 0 != cb.mDecodedCount) {
+        std::cout << "field_info::DecodeArray() failed: " << \
+            cb.mDecodedCount << " variable size items." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Returns true if the writing to the read-only 'buf' fails without a change.
+static bool isWriteRejected(const buf_val * buf) {
+    bit_ref bitRef(buf, 0);
+    uint64_t first = bitRef.ReadUInt(8);
+#ifdef DISABLE_RTTI
+    bool written = bitRef.WriteUInt(8, ~first);
+#else
+    bool written = true;
+    try {
+        written = bitRef.WriteUInt(8, ~first);
+    } catch (const std::runtime_error &) {
+        written = false;
+    }
+#endif
+    return !written && !bitRef.IsWritable() && bitRef.ReadUInt(8) == first;
+}
+
 int main() {
     std::cout << "// test bit_ref." << std::endl;
     uint8_t bitsBuf[] = {'1', '2', '3', 0};
@@ -570,6 +2220,36 @@ int main() {
     } while (1);
     std::cout << std::endl;
 
+    std::cout << "// test bit_ref::copyBits()." << std::endl;
+    if ( testCopyBits() )
+        std::cout << "bit_ref::copyBits() passed." << std::endl;
+    else
+        return 1;
+
+    std::cout << "// test bit_ref::ReadUInt()/WriteUInt()." << std::endl;
+    if ( testIntBits() )
+        std::cout << "bit_ref::ReadUInt()/WriteUInt() passed." << std::endl;
+    else
+        return 1;
+
+    std::cout << "// test LSB-first bit_ref." << std::endl;
+    if ( testBitOrder() )
+        std::cout << "LSB-first bit_ref passed." << std::endl;
+    else
+        return 1;
+
+    std::cout << "// test bit_reader/bit_writer." << std::endl;
+    if ( testBitStream() )
+        std::cout << "bit_reader/bit_writer passed." << std::endl;
+    else
+        return 1;
+
+    std::cout << "// test combined_field_des::ParseStream()." << std::endl;
+    if ( testSyncStream() )
+        std::cout << "combined_field_des::ParseStream() passed." << std::endl;
+    else
+        return 1;
+
     std::cout << "// test field_des." << std::endl;
     field_des_tree::node_ptr bmFieldDesNode = \
         field_des_tree::CreateNode(BM_FIELD_DES[0]);
@@ -591,6 +2271,123 @@ int main() {
     bm_parser_callback cb;
     BITMAP_FIELD.ParseField(&cb, biEnv);
 
+    // The following parsing uses the precompiled dependencies.
+    std::cout << "// test combined_field_des::FinalizeSchema()." << std::endl;
+    BITMAP_FIELD.FinalizeSchema(&bmFieldDesDep);
+    const field_des * const * depFieldDes = 0;
+    uint32_t depFieldCount = 0;
+    bool isDependency = false;
+    if ( !BM_FIELD_DES[7]->FinalizedDependency(
+            &bmFieldDesDep, &depFieldDes, &depFieldCount, &isDependency ) || \
+        2 != depFieldCount || isDependency || \
+        !BM_FIELD_DES[2]->FinalizedDependency(
+            &bmFieldDesDep, &depFieldDes, &depFieldCount, &isDependency ) || \
+        0 != depFieldCount || !isDependency )
+    {
+        std::cout << "combined_field_des::FinalizeSchema() failed." << \
+            std::endl;
+        return 1;
+    }
+    for (i = 0; i < 8; ++i) { // numbered in pre-order.
+        if ( BM_FIELD_DES[i]->FieldId() != i )
+            break;
+    }
+    if (i < 8) {
+        std::cout << "combined_field_des::FinalizeSchema() failed." << \
+            std::endl;
+        return 1;
+    }
+    std::cout << "combined_field_des::FinalizeSchema() passed." << std::endl;
+
+    std::cout << "// test field_info_generator::CloseScope()." << std::endl;
+    if ( testBacktraceScope() ) {
+        std::cout << "field_info_generator::CloseScope() passed." << \
+            std::endl;
+    } else
+        return 1;
+
+    std::cout << "// test combined_field_des::ParseMany()." << std::endl;
+    if ( testParseMany() )
+        std::cout << "combined_field_des::ParseMany() passed." << std::endl;
+    else
+        return 1;
+
+    std::cout << "// test field_info_span_env." << std::endl;
+    std::vector<uint8_t> extBuf( bufVal->Size() ); // as a mmap'd file.
+    memcpy( &(extBuf[0]), bufVal->Buf(), bufVal->Size() );
+    uint8_t * extData = &(extBuf[0]);
+    field_info_span_env spanEnv( &bmFieldDesDep, extData, extBuf.size() );
+    bm_size_callback bufSize, spanSize;
+    field_info_generator fieldInfoGen; // reused by the parsings.
+    BITMAP_FIELD.ParseField(&bufSize, biEnv, 0, &fieldInfoGen);
+    BITMAP_FIELD.ParseField(&spanSize, spanEnv, 0, &fieldInfoGen);
+    if ( spanEnv.mBuf->Buf() != extData || \
+        bufSize.mFieldCount != spanSize.mFieldCount || \
+        bufSize.mLeafBits != spanSize.mLeafBits )
+    {
+        std::cout << "field_info_span_env failed." << std::endl;
+        return 1;
+    }
+    // The read-only memory (e.g. a PROT_READ mmap'd file) is parsed the same
+    // way, but it can't be written.
+    const uint8_t * roData = extData;
+    field_info_span_env roEnv( &bmFieldDesDep, roData, extBuf.size() );
+    bm_size_callback roSize;
+    BITMAP_FIELD.ParseField(&roSize, roEnv, 0, &fieldInfoGen);
+    if ( roEnv.mBuf->Buf() != extData || !roEnv.mBuf->IsReadOnly() || \
+        spanEnv.mBuf->IsReadOnly() || !isWriteRejected(roEnv.mBuf) || \
+        roSize.mFieldCount != spanSize.mFieldCount || \
+        roSize.mLeafBits != spanSize.mLeafBits )
+    {
+        std::cout << "read-only field_info_span_env failed." << std::endl;
+        return 1;
+    }
+    std::cout << "field_info_span_env passed: " << spanSize.mFieldCount << \
+        " fields, " << spanSize.mLeafBits << " bits." << std::endl;
+
+    std::cout << "// test field_info_generator::CheckMessage()." << std::endl;
+    bm_checked_callback fullChecked, cutChecked;
+    BITMAP_FIELD.ParseField(&fullChecked, spanEnv, 0, &fieldInfoGen);
+    // The bm_bits array is beyond the message without its last byte.
+    field_info_span_env cutEnv( &bmFieldDesDep, extData, extBuf.size() - 1 );
+    BITMAP_FIELD.ParseField(&cutChecked, cutEnv, 0, &fieldInfoGen);
+    if ( !fullChecked.mMatched || !cutChecked.mMatched || \
+        fullChecked.mCheckedCount != fullChecked.mFieldCount || \
+        cutChecked.mCheckedCount != cutChecked.mFieldCount - 100 * 50 )
+    {
+        std::cout << "field_info_generator::CheckMessage() failed: " << \
+            fullChecked.mCheckedCount << ", " << cutChecked.mCheckedCount << \
+            " checked fields." << std::endl;
+        return 1;
+    }
+    std::cout << "field_info_generator::CheckMessage() passed." << std::endl;
+
+    std::cout << "// test field_info_range." << std::endl;
+    bm_range_callback rangeSize;
+    BITMAP_FIELD.ParseField(&rangeSize, spanEnv);
+    if ( !rangeSize.mMatched || \
+        rangeSize.mFieldCount != spanSize.mFieldCount || \
+        rangeSize.mLeafBits != spanSize.mLeafBits )
+    {
+        std::cout << "field_info_range failed." << std::endl;
+        return 1;
+    }
+    std::cout << "field_info_range passed." << std::endl;
+
+    std::cout << "// test field_info::DecodeArray()." << std::endl;
+    for (i = 20; i < extBuf.size(); ++i) // the bm_bits after the header.
+        extBuf[i] = uint8_t(i * 7);
+    bm_bits_callback bitsCb;
+    BITMAP_FIELD.ParseField(&bitsCb, spanEnv);
+    if (!bitsCb.mMatched) {
+        std::cout << "field_info::DecodeArray() failed." << std::endl;
+        return 1;
+    }
+    if ( !testVarDecodeArray() )
+        return 1;
+    std::cout << "field_info::DecodeArray() passed: " << bitsCb.mBitsCount << \
+        " items." << std::endl;
+
     std::ofstream fileOut;
     fileOut.open("field_des_ut.xml");
     field_info_conv_xml convXml(
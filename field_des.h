@@ -26,7 +26,6 @@ SOFTWARE. */
 #endif
 
 #include <vector>
-#include <list>
 #include "table.h"
 #include "tree.h"
 
@@ -34,6 +33,21 @@ namespace pdl {
 
 class field_des; // The field descriptor of binary protocol.
 
+// The offsets & sizes in bit, define ENABLE_64BIT_OFFSET (also makes buf_val
+// use 64-bit sizes) to address the buffers which are larger than 512 MiB.
+#ifdef ENABLE_64BIT_OFFSET
+typedef uint64_t bit_size_t;
+#else
+typedef uint32_t bit_size_t;
+#endif
+
+// The bit order & byte order flags of a field (refer field_des::FieldOrder()),
+// the default is MSB-first & big-endian.
+enum field_order {
+    FIELD_ORDER_LSB_FIRST = 1, // the 1st. bit of a byte is the LSB.
+    FIELD_ORDER_LITTLE_ENDIAN = 2 // the integers are little-endian.
+};
+
 struct field_des_tree_stack_data {
     uint32_t mFieldNumber;
     uint32_t mMaxFieldNum;
@@ -50,9 +64,15 @@ typedef tree<field_des_tree_traits> field_des_tree;
 // The 1st. 'field_des' is the dependent field of the 2nd. 'field_des'.
 typedef table<const field_des *,const field_des *> field_des_dependency;
 
+class unchecked_bit_ref;
+
 class bit_ref {
+    friend class unchecked_bit_ref;
+    friend class field_info;
+
     buf_val * mBuf;
-    uint32_t mOffset; // In bit.
+    bit_size_t mOffset; // In bit.
+    bool mLsbFirst;
 
     void checkValid(const char * errTag) const {
         if ( !IsValid() ) {
@@ -61,10 +81,20 @@ class bit_ref {
             );
         }
     }
-    static uint8_t bitMask(uint32_t offset) {
-        return uint8_t(1) << ( 7 - (offset & 7) );
+    bool checkWritable(const char * errTag) const {
+        if ( mBuf && mBuf->IsReadOnly() ) {
+            PDL_THROW(
+                std::runtime_error( std::string(errTag) + " read-only!" )
+            );
+            return false;
+        }
+        return true;
+    }
+    inline void refUnchecked(unchecked_bit_ref * out_ref) const;
+    static uint8_t bitMask(bit_size_t offset, bool lsbFirst) {
+        return uint8_t(1) << ( lsbFirst? (offset & 7): 7 - (offset & 7) );
     }
-    static uint32_t blockIdx(uint32_t offset) {
+    static buf_size_t blockIdx(bit_size_t offset) {
         return (offset >> 3);
     }
     uint8_t getBlock() const {
@@ -74,43 +104,107 @@ class bit_ref {
         return static_cast<uint8_t *>( mBuf->Buf() )[blockIdx(mOffset)];
     }
     bool getVal() const {
-        return static_cast<bool>( getBlock() & bitMask(mOffset) );
+        return static_cast<bool>( getBlock() & bitMask(mOffset, mLsbFirst) );
     }
     void setVal(bool bit) {
         if (bit)
-            getBlock() |= bitMask(mOffset);
+            getBlock() |= bitMask(mOffset, mLsbFirst);
         else
-            getBlock() &= ~ bitMask(mOffset);
+            getBlock() &= ~ bitMask(mOffset, mLsbFirst);
     }
-    static uint32_t copyBits(
+    static void copyBitsImp(
+        const uint8_t * src,
+        bit_size_t srcOffset,
+        uint8_t * dst,
+        bit_size_t dstOffset,
+        bit_size_t length,
+        bool lsbFirst
+    );
+    bool checkIntRange(
+        const char * errTag, uint32_t nbits, bool littleEndian
+    ) const;
+    static uint64_t readBits(
+        const uint8_t * data,
+        buf_size_t size,
+        bit_size_t offset,
+        uint32_t nbits,
+        bool lsbFirst
+    );
+    static void writeBits(
+        uint8_t * data,
+        buf_size_t size,
+        bit_size_t offset,
+        uint32_t nbits,
+        uint64_t val,
+        bool lsbFirst
+    );
+    static uint64_t readUInt(
+        const uint8_t * data,
+        buf_size_t size,
+        bit_size_t offset,
+        uint32_t nbits,
+        bool littleEndian,
+        bool lsbFirst
+    );
+    static void writeUInt(
+        uint8_t * data,
+        buf_size_t size,
+        bit_size_t offset,
+        uint32_t nbits,
+        uint64_t val,
+        bool littleEndian,
+        bool lsbFirst
+    );
+    uint32_t readUInts(
+        uint32_t nbits,
+        uint32_t count,
+        void * out_vals,
+        uint32_t valSize,
+        bool littleEndian
+    ) const;
+    static bit_size_t copyBits(
         const buf_val * src,
         buf_val * dst,
-        uint32_t srcOffset,
-        uint32_t dstOffset,
-        uint32_t length
+        bit_size_t srcOffset,
+        bit_size_t dstOffset,
+        bit_size_t length,
+        bool lsbFirst
     );
-    static uint32_t copyBits(
+    static bit_size_t copyBits(
         const uint8_t * src,
-        uint32_t srcSize,
-        uint32_t srcOffset,
+        buf_size_t srcSize,
+        bit_size_t srcOffset,
         uint8_t * dst,
-        uint32_t dstSize,
-        uint32_t dstOffset,
-        uint32_t length
+        buf_size_t dstSize,
+        bit_size_t dstOffset,
+        bit_size_t length,
+        bool lsbFirst
     );
 
 public:
-    explicit bit_ref(buf_val * buf, uint32_t offset) {
+    // The bits are numbered from the MSB of each byte by default, or from the
+    // LSB if 'lsbFirst' is true; the exported/imported bits keep the order.
+    explicit bit_ref(buf_val * buf, bit_size_t offset, bool lsbFirst = false) {
         mBuf = buf;
         mOffset = offset;
+        mLsbFirst = lsbFirst;
     }
-    explicit bit_ref(const buf_val * buf, uint32_t offset) {
+    explicit bit_ref(
+        const buf_val * buf, bit_size_t offset, bool lsbFirst = false)
+    {
         mBuf = const_cast<buf_val *>(buf);
         mOffset = offset;
+        mLsbFirst = lsbFirst;
     }
     bit_ref(const bit_ref & src) {
         mBuf = src.mBuf;
         mOffset = src.mOffset;
+        mLsbFirst = src.mLsbFirst;
+    }
+    // Saturates instead of overflow if the buffer is too large to address.
+    static bit_size_t BitsOf(buf_size_t size) {
+        return ( size > ( bit_size_t(-1) >> 3 ) ) \
+            ? bit_size_t(-1): ( bit_size_t(size) << 3 );
     }
     const buf_val * Buf() const {
         return mBuf;
@@ -118,29 +212,40 @@ public:
     buf_val * Buf() {
         return mBuf;
     }
-    uint32_t Offset() const {
+    bit_size_t Offset() const {
         return mOffset;
     }
-    uint32_t MaxSize() const {
-        return mBuf? ( mBuf->Size() << 3 ): 0;
+    bool IsLsbFirst() const {
+        return mLsbFirst;
+    }
+    bit_size_t MaxSize() const {
+        return mBuf? BitsOf( mBuf->Size() ): 0;
     }
     bool IsValid() const {
         return mOffset < MaxSize();
     }
+    // False if the buffer is attached read-only (see buf_val::Attach()).
+    bool IsWritable() const {
+        return mBuf && !mBuf->IsReadOnly();
+    }
     bool Val() const {
         checkValid("bit_ref::Val()");
         return getVal();
     }
-    uint32_t ExportBits(
-        uint32_t length, buf_val * out_bitsBuf, uint32_t startOffset = 0) const
+    bit_size_t ExportBits(
+        bit_size_t length,
+        buf_val * out_bitsBuf,
+        bit_size_t startOffset = 0) const
     {
-        return copyBits(mBuf, out_bitsBuf, mOffset, startOffset, length);
+        return copyBits(
+            mBuf, out_bitsBuf, mOffset, startOffset, length, mLsbFirst
+        );
     }
-    uint32_t ExportBits(
-        uint32_t length,
+    bit_size_t ExportBits(
+        bit_size_t length,
         uint8_t * out_bitsBuf,
-        uint32_t bufSize,
-        uint32_t startOffset = 0) const
+        buf_size_t bufSize,
+        bit_size_t startOffset = 0) const
     {
         if (mBuf) {
             return copyBits(
@@ -150,23 +255,26 @@ public:
                 out_bitsBuf,
                 bufSize,
                 startOffset,
-                length
+                length,
+                mLsbFirst
             );
         }
         return 0;
     }
-    uint32_t ImportBits(
-        uint32_t length, const buf_val * data, uint32_t startOffset = 0)
+    bit_size_t ImportBits(
+        bit_size_t length, const buf_val * data, bit_size_t startOffset = 0)
     {
-        return copyBits(data, mBuf, startOffset, mOffset, length);
+        return copyBits(
+            data, mBuf, startOffset, mOffset, length, mLsbFirst
+        );
     }
-    uint32_t ImportBits(
-        uint32_t length,
+    bit_size_t ImportBits(
+        bit_size_t length,
         const uint8_t * data,
-        uint32_t dataSize,
-        uint32_t startOffset = 0)
+        buf_size_t dataSize,
+        bit_size_t startOffset = 0)
     {
-        if (mBuf) {
+        if ( mBuf && checkWritable("bit_ref::ImportBits()") ) {
             return copyBits(
                 data,
                 dataSize,
@@ -174,24 +282,63 @@ public:
                 static_cast<uint8_t *>( mBuf->Buf() ),
                 mBuf->Size(),
                 mOffset,
-                length
+                length,
+                mLsbFirst
             );
         }
         return 0;
     }
+    // Reads/writes a 'nbits' (1 ~ 64) integer directly from/to the buffer, the
+    // 1st. bit is the MSB of the integer for the MSB-first bits, or the LSB for
+    // the LSB-first bits, that is big-endian or little-endian by nature; the
+    // other byte order is only available if 'nbits' is whole bytes, and it is
+    // ignored if 'nbits' is 8 or less.
+    uint64_t ReadUInt(uint32_t nbits, bool littleEndian = false) const;
+    int64_t ReadInt(uint32_t nbits, bool littleEndian = false) const {
+        uint64_t val = ReadUInt(nbits, littleEndian);
+        if ( nbits < 64 && ( val >> (nbits - 1) ) ) // extend the sign bit.
+            val |= ~uint64_t(0) << nbits;
+        return static_cast<int64_t>(val);
+    }
+    bool WriteUInt(uint32_t nbits, uint64_t val, bool littleEndian = false);
+    bool WriteInt(uint32_t nbits, int64_t val, bool littleEndian = false) {
+        return WriteUInt( nbits, static_cast<uint64_t>(val), littleEndian );
+    }
+    // Reads 'count' successive 'nbits' (1 ~ sizeof(T) * 8) integers into
+    // 'out_vals' in one pass, returns the count of the read integers.
+    template <typename T>
+    uint32_t ReadUInts(
+        uint32_t nbits,
+        uint32_t count,
+        T * out_vals,
+        bool littleEndian = false) const
+    {
+        return readUInts( nbits, count, out_vals, sizeof(T), littleEndian );
+    }
+    // Searches the byte 'pattern' from the 1st. byte boundary at or after the
+    // current offset, returns the bit offset of the match or MaxSize().
+    bit_size_t FindBytes(const uint8_t * pattern, buf_size_t size) const;
+    // Searches the 'nbits' (1 ~ 57) 'pattern' at any bit offset from the
+    // current offset, returns the bit offset of the match or MaxSize().
+    bit_size_t FindBits(uint64_t pattern, uint32_t nbits) const;
+    // Checks the 'length' bits from the current offset once, and returns the
+    // reference without the per-access checks for the range.
+    inline bool Unchecked(bit_size_t length, unchecked_bit_ref * out_ref) const;
     bit_ref & operator =(const bit_ref & src) {
         mBuf = src.mBuf;
         mOffset = src.mOffset;
+        mLsbFirst = src.mLsbFirst;
         return *this;
     }
     bit_ref & operator =(bool bit) {
         checkValid("bit_ref::operator =()");
-        setVal(bit);
+        if ( checkWritable("bit_ref::operator =()") )
+            setVal(bit);
         return *this;
     }
-    bit_ref & operator +=(uint32_t offset) {
+    bit_ref & operator +=(bit_size_t offset) {
         if (offset) {
-            if ( mOffset + offset > MaxSize() ) {
+            if ( mOffset > MaxSize() || offset > MaxSize() - mOffset ) {
                 PDL_THROW( std::overflow_error(
                     "bit_ref::operator +=() overflow!"
                 ) );
@@ -200,7 +347,7 @@ public:
         }
         return *this;
     }
-    bit_ref & operator -=(uint32_t offset) {
+    bit_ref & operator -=(bit_size_t offset) {
         if (offset) {
             if (mOffset < offset) {
                 PDL_THROW(  std::underflow_error(
@@ -219,28 +366,326 @@ public:
     }
 };
 
+// The bit_ref without any check, which is only created by bit_ref::Unchecked(),
+// so it is the caller's duty to keep the accesses inside the checked range and
+// to pass valid arguments; the writing needs bit_ref::IsWritable().
+class unchecked_bit_ref {
+    friend class bit_ref;
+
+    uint8_t * mData;
+    buf_size_t mSize; // In byte, to select the fast path of the integers.
+    bit_size_t mOffset; // In bit.
+    bool mLsbFirst;
+
+    uint8_t bitMask() const {
+        return bit_ref::bitMask(mOffset, mLsbFirst);
+    }
+
+public:
+    unchecked_bit_ref() {
+        mData = 0;
+        mSize = 0;
+        mOffset = 0;
+        mLsbFirst = false;
+    }
+    bit_size_t Offset() const {
+        return mOffset;
+    }
+    bool IsLsbFirst() const {
+        return mLsbFirst;
+    }
+    bool Val() const {
+        return static_cast<bool>( mData[mOffset >> 3] & bitMask() );
+    }
+    void ExportBits(
+        bit_size_t length,
+        uint8_t * out_bitsBuf,
+        bit_size_t startOffset = 0) const
+    {
+        bit_ref::copyBitsImp(
+            mData, mOffset, out_bitsBuf, startOffset, length, mLsbFirst
+        );
+    }
+    void ImportBits(
+        bit_size_t length, const uint8_t * data, bit_size_t startOffset = 0)
+    {
+        bit_ref::copyBitsImp(
+            data, startOffset, mData, mOffset, length, mLsbFirst
+        );
+    }
+    uint64_t ReadUInt(uint32_t nbits, bool littleEndian = false) const {
+        return bit_ref::readUInt(
+            mData, mSize, mOffset, nbits, littleEndian, mLsbFirst
+        );
+    }
+    int64_t ReadInt(uint32_t nbits, bool littleEndian = false) const {
+        uint64_t val = ReadUInt(nbits, littleEndian);
+        if ( nbits < 64 && ( val >> (nbits - 1) ) ) // extend the sign bit.
+            val |= ~uint64_t(0) << nbits;
+        return static_cast<int64_t>(val);
+    }
+    void WriteUInt(uint32_t nbits, uint64_t val, bool littleEndian = false) {
+        bit_ref::writeUInt(
+            mData, mSize, mOffset, nbits, val, littleEndian, mLsbFirst
+        );
+    }
+    void WriteInt(uint32_t nbits, int64_t val, bool littleEndian = false) {
+        WriteUInt( nbits, static_cast<uint64_t>(val), littleEndian );
+    }
+    unchecked_bit_ref & operator =(bool bit) {
+        if (bit)
+            mData[mOffset >> 3] |= bitMask();
+        else
+            mData[mOffset >> 3] &= ~ bitMask();
+        return *this;
+    }
+    unchecked_bit_ref & operator +=(bit_size_t offset) {
+        mOffset += offset;
+        return *this;
+    }
+    unchecked_bit_ref & operator -=(bit_size_t offset) {
+        mOffset -= offset;
+        return *this;
+    }
+    unchecked_bit_ref & operator ++() {
+        ++mOffset;
+        return *this;
+    }
+    unchecked_bit_ref & operator --() {
+        --mOffset;
+        return *this;
+    }
+};
+
+inline bool bit_ref::Unchecked(
+    bit_size_t length, unchecked_bit_ref * out_ref) const
+{
+    bit_size_t maxSize = MaxSize();
+    if ( !mBuf || mOffset > maxSize || length > maxSize - mOffset ) {
+        PDL_THROW( std::overflow_error("bit_ref::Unchecked() overflow!") );
+        return false;
+    }
+    if (out_ref)
+        refUnchecked(out_ref);
+    return true;
+}
+
+inline void bit_ref::refUnchecked(unchecked_bit_ref * out_ref) const {
+    out_ref->mData = static_cast<uint8_t *>( mBuf->Buf() );
+    out_ref->mSize = mBuf->Size();
+    out_ref->mOffset = mOffset;
+    out_ref->mLsbFirst = mLsbFirst;
+}
+
+// Reads the MSB-first bits front to back through a 64-bit cache, which is
+// cheaper than the random access of bit_ref for the sequential decoding.
+// NOTE: the LSB-first bit_ref is NOT supported, it results in an empty reader.
+class bit_reader {
+    const uint8_t * mData;
+    buf_size_t mSize; // In byte.
+    bit_size_t mMaxSize; // In bit.
+    bit_size_t mNextOffset; // The offset of the 1st. bit after the cache.
+    uint64_t mCache; // The cached bits are MSB aligned.
+    uint32_t mCacheBits;
+
+    void refill();
+
+public:
+    explicit bit_reader(
+        const uint8_t * data, buf_size_t size, bit_size_t offset = 0);
+    explicit bit_reader(const bit_ref & bitRef);
+
+    bit_size_t Offset() const {
+        return mNextOffset - mCacheBits;
+    }
+    bit_size_t MaxSize() const {
+        return mMaxSize;
+    }
+    bit_size_t RemainedBits() const {
+        return mMaxSize - Offset();
+    }
+    // Returns the next 'nbits' (1 ~ 57) bits without consuming them, the bits
+    // beyond the end are read as 0.
+    uint64_t Peek(uint32_t nbits) {
+        if (mCacheBits < nbits)
+            refill();
+        return mCache >> (64 - nbits);
+    }
+    void Skip(bit_size_t nbits) {
+        if (nbits <= mCacheBits) {
+            mCache = (nbits < 64)? (mCache << nbits): 0;
+            mCacheBits -= nbits;
+        } else
+            Seek(Offset() + nbits);
+    }
+    // Reads 'nbits' (1 ~ 64) bits.
+    uint64_t Read(uint32_t nbits) {
+        if (nbits > 57) {
+            uint64_t hi = Read(nbits - 32) << 32;
+            return hi | Read(32);
+        }
+        uint64_t val = Peek(nbits);
+        if (nbits > RemainedBits()) {
+            PDL_THROW( std::overflow_error("bit_reader::Read() overflow!") );
+        }
+        Skip(nbits);
+        return val;
+    }
+    void AlignToByte() {
+        Skip( ( 8 - (Offset() & 7) ) & 7 );
+    }
+    void Seek(bit_size_t offset);
+};
+
+// Writes the MSB-first bits front to back through a 64-bit cache, the buffer
+// is resized if it is too small, and the bits are flushed when the cache is
+// full, by Flush() or by the destructor; the destructor never throws, so it
+// drops the bits for a read-only buffer.
+class bit_writer {
+    buf_val * mBuf;
+    bit_size_t mOffset; // The offset of the 1st. cached bit.
+    uint64_t mCache; // The cached bits are MSB aligned.
+    uint32_t mCacheBits;
+
+public:
+    explicit bit_writer(buf_val * buf, bit_size_t offset = 0) {
+        mBuf = buf;
+        mOffset = offset;
+        mCache = 0;
+        mCacheBits = 0;
+    }
+    ~bit_writer() {
+        if ( bit_ref(mBuf, mOffset).IsWritable() )
+            Flush();
+    }
+    bit_size_t Offset() const {
+        return mOffset + mCacheBits;
+    }
+    // Writes the low 'nbits' (0 ~ 64) bits of 'val'.
+    void Write(uint32_t nbits, uint64_t val) {
+        if (nbits > 32) {
+            Write(nbits - 32, val >> 32);
+            nbits = 32;
+        }
+        if (nbits) {
+            if (mCacheBits + nbits > 64)
+                Flush();
+            val &= ~uint64_t(0) >> (64 - nbits);
+            mCache |= val << (64 - mCacheBits - nbits);
+            mCacheBits += nbits;
+        }
+    }
+    // Pads 0 bits to the byte boundary.
+    void AlignToByte() {
+        Write( ( 8 - (Offset() & 7) ) & 7, 0 );
+    }
+    // The cached bits are dropped even if the writing fails (throws).
+    void Flush();
+};
+
 struct field_info_ctx: field_des_tree_stack_data {
-    uint32_t mFieldOffset; // In bit.
-    uint32_t mFieldSize; // In bit.
+    bit_size_t mFieldOffset; // In bit.
+    bit_size_t mFieldSize; // In bit.
     const field_des * mFieldDes;
+    // The integer value of a dependency field which is decoded once by the
+    // generator, so FieldCount() & FieldSize() of the fields depending on it
+    // need not decode it again; valid only if mIsDecoded.
+    uint64_t mDecodedVal;
+    bool mIsDecoded;
+    // The field is inside the message range which the generator has checked
+    // against the buffer (see field_info_generator::CheckMessage()).
+    bool mIsChecked;
 
     field_info_ctx() {
         mFieldOffset = 0;
         mFieldSize = 0;
         mFieldDes = 0;
+        mDecodedVal = 0;
+        mIsDecoded = false;
+        mIsChecked = false;
     }
     field_info_ctx(
-        const field_des * fieldDes, uint32_t fieldOffset, uint32_t fieldNum)
+        const field_des * fieldDes, bit_size_t fieldOffset, uint32_t fieldNum)
     {
         mFieldNumber = fieldNum;
         mFieldOffset = fieldOffset;
         mFieldSize = 0;
         mFieldDes = fieldDes;
+        mDecodedVal = 0;
+        mIsDecoded = false;
+        mIsChecked = false;
     }
 };
 
+class field_info;
+class combined_field_des;
+
 class field_des {
+    friend class combined_field_des;
+    typedef std_allocator<const field_des *,field_info> cp_field_des_allocator;
+    typedef std::vector<const field_des *,cp_field_des_allocator> field_des_buf;
+
+    uint32_t mFieldId;
+    // The dependencies which are precompiled by FinalizeSchema() for the
+    // 'mFinalizedDep' table.
+    const field_des_dependency * mFinalizedDep;
+    field_des_buf mDepFieldDes;
+    bool mIsDependency;
+    // The dependency fields whose dependents are all in an item of this
+    // field, i.e. the scope which they are evicted from the backtrace after.
+    field_des_buf mScopedDepFieldDes;
+    const field_des * mParentFieldDes;
+
 public:
+    enum field_id_value {
+        FIELD_ID_NONE = 0xffffffff
+    };
+
+    // The field_des gets its id by combined_field_des::FinalizeSchema().
+    field_des();
+    field_des(const field_des & src);
+    field_des & operator =(const field_des & src) {
+        mTreeNode = src.mTreeNode; // the id is kept.
+        return *this;
+    }
+    // The dense id (0 ~ the count of fields - 1) in the finalized tree, or
+    // FIELD_ID_NONE if the field is not finalized.
+    uint32_t FieldId() const {
+        return mFieldId;
+    }
+    // Returns true if the dependencies of the field are precompiled for the
+    // 'fieldDesDep', and then outputs the count & the fields it depends on,
+    // and whether any field depends on it.
+    bool FinalizedDependency(
+        const field_des_dependency * fieldDesDep,
+        const field_des * const ** out_depFieldDes,
+        uint32_t * out_depFieldCount,
+        bool * out_isDependency) const
+    {
+        if ( !fieldDesDep || fieldDesDep != mFinalizedDep )
+            return false;
+        *out_depFieldDes = mDepFieldDes.size()? &(mDepFieldDes[0]): 0;
+        *out_depFieldCount = static_cast<uint32_t>( mDepFieldDes.size() );
+        *out_isDependency = mIsDependency;
+        return true;
+    }
+    // Returns true if the dependencies of the field are precompiled for the
+    // 'fieldDesDep', and then outputs the count & the dependency fields which
+    // are out of date once an item of this field is parsed.
+    bool FinalizedScope(
+        const field_des_dependency * fieldDesDep,
+        const field_des * const ** out_scopedDepFieldDes,
+        uint32_t * out_scopedDepFieldCount) const
+    {
+        if ( !fieldDesDep || fieldDesDep != mFinalizedDep )
+            return false;
+        *out_scopedDepFieldDes = mScopedDepFieldDes.size() \
+            ? &(mScopedDepFieldDes[0]): 0;
+        *out_scopedDepFieldCount = \
+            static_cast<uint32_t>( mScopedDepFieldDes.size() );
+        return true;
+    }
+
     virtual const char * FieldName() const = 0;
 
     virtual uint32_t FieldCount(
@@ -249,12 +694,25 @@ public:
         uint32_t depFieldInfoCount
     ) const = 0;
 
-    virtual uint32_t FieldSize(
+    virtual bit_size_t FieldSize(
         bit_ref bitRef,
         const field_info_ctx * depFieldInfo,
         uint32_t depFieldInfoCount
     ) const = 0; // In bit.
 
+    // Returns the size (in bit) if FieldSize() always returns it, or 0 if the
+    // size is variable; the items of a constant size array are placed by the
+    // arithmetic without invoking FieldSize() for each one.
+    virtual bit_size_t ConstFieldSize() const {
+        return 0;
+    }
+
+    // The field_order flags of the field, the bit_ref passed to the field
+    // descriptor & created by field_info::RefBits() follows the bit order.
+    virtual uint32_t FieldOrder() const {
+        return 0;
+    }
+
 protected:
     field_des_tree::node_ptr_c mTreeNode;
 
@@ -283,10 +741,19 @@ class leaf_field_des: public field_des {
 public:
     virtual bool DecodeField(bit_ref bitRef, value_obj * out_val) const = 0;
     virtual bool EncodeField(bit_ref bitRef, const value_obj * val) const = 0;
+    // Decodes the field as an unsigned integer, returns false if the value is
+    // not an integer; the default one decodes by DecodeField(), override it
+    // for the dependency fields to skip the value_obj.
+    virtual bool DecodeInt(bit_ref bitRef, uint64_t * out_val) const;
+    // Returns true if the field is a plain unsigned integer of ConstFieldSize()
+    // bits in the byte order of FieldOrder(), that is DecodeField() and
+    // EncodeField() do nothing else (e.g. no checksum), so the generated codes
+    // (see static_decoder_gen) can access it without them.
+    virtual bool IsRawUInt() const {
+        return false;
+    }
 };
 
-class combined_field_des;
-
 class field_info: public obj_base {
     friend class field_info_generator;
 
@@ -335,10 +802,10 @@ public:
             ? static_cast<const leaf_field_des *>(mCtx.mFieldDes): 0;
     }
     inline const combined_field_des * CombinedFieldDes() const;
-    uint32_t Offset() const {
+    bit_size_t Offset() const {
         return mCtx.mFieldOffset;
     }
-    uint32_t SizeInBit() const {
+    bit_size_t SizeInBit() const {
         return mCtx.mFieldSize;
     }
     uint32_t FieldNumber() const {
@@ -348,7 +815,26 @@ public:
         return mCtx.mMaxFieldNum;
     }
     bit_ref RefBits(const buf_val * buf) const {
-        return bit_ref(buf, mCtx.mFieldOffset);
+        return bit_ref(
+            buf,
+            mCtx.mFieldOffset,
+            mCtx.mFieldDes && \
+                ( mCtx.mFieldDes->FieldOrder() & FIELD_ORDER_LSB_FIRST )
+        );
+    }
+    // True if the field is inside the message range which is checked once by
+    // the parsing, so RefBits(buf, out_ref) checks nothing for its buffer.
+    bool IsChecked() const {
+        return mCtx.mIsChecked;
+    }
+    // Returns false if the field is beyond the buffer; 'buf' should be the
+    // buffer of the parsing if the field IsChecked().
+    bool RefBits(const buf_val * buf, unchecked_bit_ref * out_ref) const {
+        if (mCtx.mIsChecked && out_ref) {
+            RefBits(buf).refUnchecked(out_ref);
+            return true;
+        }
+        return RefBits(buf).Unchecked(mCtx.mFieldSize, out_ref);
     }
     bool DecodeValue(const buf_val * buf, value_obj * out_val) const {
         const leaf_field_des * fieldDes = LeafFieldDes();
@@ -357,6 +843,13 @@ public:
         }
         return false;
     }
+    // Decodes the items from this one to the last one of a fixed-size leaf
+    // array, which are unsigned integers in the field order, into 'out_vals'
+    // without any value_obj; returns the count of the decoded items, or 0 if
+    // the field size is larger than T or not a ConstFieldSize().
+    template <typename T>
+    uint32_t DecodeArray(
+        const buf_val * buf, T * out_vals, uint32_t maxCount) const;
     bool EncodeValue(buf_val * out_buf, const value_obj * val) const {
         const leaf_field_des * fieldDes = LeafFieldDes();
         if (fieldDes)
@@ -368,6 +861,24 @@ public:
     static mem_allocator * Allocator();
 };
 
+template <typename T>
+uint32_t field_info::DecodeArray(
+    const buf_val * buf, T * out_vals, uint32_t maxCount) const
+{
+    checkValid("field_info::DecodeArray()");
+    uint32_t n = (ItemCount() < maxCount)? ItemCount(): maxCount;
+    bit_size_t itemSize = FieldDes()->ConstFieldSize();
+    if ( 0 == n || 0 == itemSize || itemSize != SizeInBit() || \
+         itemSize > (sizeof(T) << 3) )
+        return 0;
+    return RefBits(buf).ReadUInts(
+        static_cast<uint32_t>(itemSize),
+        n,
+        out_vals,
+        0 != ( FieldDes()->FieldOrder() & FIELD_ORDER_LITTLE_ENDIAN )
+    );
+}
+
 template <>
 struct obj_constructor<field_info> {
     const field_info_ctx * mArgs;
@@ -386,22 +897,143 @@ struct obj_constructor<field_info> {
 };
 
 typedef std_allocator<field_info_ctx,field_info> field_info_ctx_allocator;
-typedef std::list<field_info_ctx,field_info_ctx_allocator> \
-    field_info_backtrace_buf;
 
 struct field_info_env {
     const field_des_dependency * mFieldDesDep;
     buf_val * mBuf;
 };
 
+// The env over an external memory (e.g. a mmap'd file or a ring buffer) which
+// is parsed without copy, the memory is NOT owned and should be alive during
+// the parsing; the read-only memory can't be encoded (see buf_val::Attach()).
+class field_info_span_env: public field_info_env {
+    buf_val mSpan;
+
+    field_info_span_env(const field_info_span_env &); // non-copyable.
+    field_info_span_env & operator =(const field_info_span_env &);
+
+public:
+    field_info_span_env(
+        const field_des_dependency * fieldDesDep,
+        uint8_t * data,
+        buf_size_t size)
+    {
+        mFieldDesDep = fieldDesDep;
+        mSpan.Attach(data, size);
+        mBuf = &mSpan;
+    }
+    field_info_span_env(
+        const field_des_dependency * fieldDesDep,
+        const uint8_t * data,
+        buf_size_t size)
+    {
+        mFieldDesDep = fieldDesDep;
+        mSpan.Attach(data, size);
+        mBuf = &mSpan;
+    }
+};
+
+// The lazy view of the items of a leaf field (array), which computes the item
+// on demand instead of a field_info per item, i.e. O(1) memory for any count;
+// it is valid in the callback only. The items of a constant size array are
+// random accessed, the others are computed one by one (fast for the forward
+// iteration).
+class field_info_range {
+    friend class field_info_generator;
+
+    field_info_ctx mFirstItem;
+    uint32_t mCount;
+    bit_size_t mConstSize;
+    const buf_val * mBuf;
+    bool mLsbFirst;
+    const field_info_ctx * mDepFieldInfo;
+    uint32_t mDepFieldInfoCount;
+    bit_size_t mCheckedEnd; // refer field_info_generator::mCheckedEnd.
+    mutable field_info_ctx mCurItem; // the last computed item.
+    mutable uint32_t mCurIdx;
+
+    // The items of a constant size array are checked all at once.
+    bool isChecked(const field_info_ctx & item) const {
+        if ( 0 == mCheckedEnd || item.mFieldOffset > mCheckedEnd )
+            return false;
+        bit_size_t size = mCheckedEnd - item.mFieldOffset;
+        return mConstSize? mCount <= size / mConstSize: \
+            item.mFieldSize <= size;
+    }
+
+public:
+    field_info_range() {
+        mCount = 0;
+        mConstSize = 0;
+        mBuf = 0;
+        mLsbFirst = false;
+        mDepFieldInfo = 0;
+        mDepFieldInfoCount = 0;
+        mCheckedEnd = 0;
+        mCurIdx = 0;
+    }
+
+    const field_des * FieldDes() const {
+        return mFirstItem.mFieldDes;
+    }
+    uint32_t Count() const {
+        return mCount;
+    }
+    bool IsConstSize() const {
+        return 0 != mConstSize;
+    }
+    bit_size_t Offset() const {
+        return mFirstItem.mFieldOffset;
+    }
+    // The offset after the last item.
+    bit_size_t EndOffset() const;
+    // Outputs the i-th (0 ~ Count() - 1) item, returns false if out of range.
+    bool ItemAt(uint32_t i, field_info_ctx * out_item) const;
+    bit_ref RefBits(const buf_val * buf, const field_info_ctx & item) const {
+        return bit_ref(buf, item.mFieldOffset, mLsbFirst);
+    }
+    // Decodes the items of a constant size array like field_info::DecodeArray()
+    // does, returns 0 if the size is variable or larger than T.
+    template <typename T>
+    uint32_t DecodeArray(
+        const buf_val * buf, T * out_vals, uint32_t maxCount) const
+    {
+        uint32_t n = (mCount < maxCount)? mCount: maxCount;
+        if ( 0 == n || 0 == mConstSize || mConstSize > (sizeof(T) << 3) )
+            return 0;
+        return bit_ref(buf, mFirstItem.mFieldOffset, mLsbFirst).ReadUInts(
+            static_cast<uint32_t>(mConstSize),
+            n,
+            out_vals,
+            0 != ( FieldDes()->FieldOrder() & FIELD_ORDER_LITTLE_ENDIAN )
+        );
+    }
+};
+
 class field_info_generator {
     typedef std_allocator<const field_des *,field_info> cp_field_des_allocator;
     typedef std::vector<const field_des *,cp_field_des_allocator> field_des_buf;
     typedef std::vector<field_info_ctx,field_info_ctx_allocator> field_info_buf;
+    typedef std_allocator<uint32_t,field_info> field_id_allocator;
+    typedef std::vector<uint32_t,field_id_allocator> field_id_buf;
 
-    field_info_backtrace_buf mBacktraceBuf;
+    // The latest field_info_ctx of each dependency field, which is indexed by
+    // field_des::FieldId(), so the lookup is O(1) for any message size and
+    // the slots are never more than the fields of the finalized tree; the
+    // slot is valid only if its mFieldDes is the dependency field_des and its
+    // mFieldSize is not 0 (evicted).
+    field_info_buf mBacktraceSlots;
+    field_id_buf mUsedSlotIds;
+    // The latest field_info_ctx of each dependency field without an id (i.e.
+    // the schema is not finalized), which is searched one by one.
+    field_info_buf mBacktraceBuf;
+
+    field_info_ctx * backtraceSlot(const field_des * fieldDes);
     field_des_buf mDepFieldDesBuf;
     field_info_buf mDepFieldInfoBuf;
+    // The end of the message range checked by CheckMessage(), or 0; the fields
+    // inside it are created with field_info_ctx::mIsChecked.
+    bit_size_t mCheckedEnd;
 
     bool findDepFieldInfo(
         const field_des * depFieldDes, field_info_ctx * out_depFieldInfo
@@ -413,13 +1045,71 @@ class field_info_generator {
     );
 
 public:
+    field_info_generator() {
+        mCheckedEnd = 0;
+    }
+
     obj_ptr<field_info> CreateFieldInfo(
         const field_info_env & env, field_info_ctx * io_args
     );
-    void PushBacktraceItem(const obj_ptr<field_info> & fieldInfo);
+    // Creates the lazy view instead of the field_info objects, returns false
+    // if there is no item; the range is valid until the next creation.
+    bool CreateFieldInfoRange(
+        const field_info_env & env,
+        field_info_ctx * io_args,
+        field_info_range * out_range
+    );
+    obj_ptr<field_info> CreateFieldInfo(const field_info_range & range);
+    // Checks the 1st. item of 'io_range' (the root field of a message) against
+    // the buffer of 'env' once, so the fields inside it are created as checked
+    // until Reset(); returns false if the message is beyond the buffer, then
+    // each field is checked by its own access.
+    bool CheckMessage(const field_info_env & env, field_info_range * io_range);
+    // Computes the size of the 1st. item of 'fieldInfo' again with the data in
+    // the buffer of 'env' (e.g. after more data is appended), and keeps
+    // 'defaultSize' if it is still 0; returns the computed size.
+    bit_size_t RefreshFieldSize(
+        const field_info_env & env,
+        obj_ptr<field_info> & fieldInfo,
+        bit_size_t defaultSize = 0
+    );
+    // Keeps the field as the latest one of its field_des for the fields
+    // depending on it; the integer value of a leaf field is also decoded into
+    // the backtrace if 'buf' is given.
+    void PushBacktraceItem(
+        const obj_ptr<field_info> & fieldInfo, const buf_val * buf = 0
+    );
+    void PushBacktraceItem(
+        const field_info_ctx & fieldInfo, const buf_val * buf = 0
+    );
+    // Evicts the backtrace items which no field depends on after an item of
+    // 'fieldDes' is parsed, so the long repeated structures never see the
+    // fields of the previous items; it needs the schema to be finalized by
+    // combined_field_des::FinalizeSchema(), otherwise nothing is evicted.
+    void CloseScope(
+        const field_des_dependency * fieldDesDep, const field_des * fieldDes
+    );
+    // The count of the valid backtrace items.
+    uint32_t BacktraceItemCount() const;
     void Reset();
 };
 
+// The byte pattern at the start of each message (e.g. 0x47 of MPEG-TS), which
+// is used to resynchronize the stream after a broken message.
+struct sync_pattern {
+    const uint8_t * mBytes;
+    uint32_t mSize;
+    uint32_t mPeriod; // in byte, 0 for the variable-size messages.
+    uint32_t mConfirmCount;
+
+    // Checks the pattern at 'pos' (byte aligned) only.
+    bool Match(const bit_ref & pos) const;
+    // Returns the bit offset of the 1st. match at or after 'pos' which is
+    // confirmed by the patterns at the next 'mConfirmCount' periods (the ones
+    // beyond the buffer are not checked), or the max size if not found.
+    bit_size_t Find(const bit_ref & pos) const;
+};
+
 class combined_field_des: public field_des {
 public:
     struct parse_callback {
@@ -428,36 +1118,109 @@ public:
         virtual int Callback(
             const field_info_env & env, obj_ptr<field_info> & fieldInfo
         ) = 0;
+        // The leaf arrays of at least the count of items are passed to
+        // ArrayCallback() as the lazy views instead of Callback(), 0 disables.
+        virtual uint32_t LazyArrayThreshold() const {
+            return 0;
+        }
+        virtual int ArrayCallback(
+            const field_info_env & env, const field_info_range & range)
+        {
+            return 0;
+        }
+        // Notifies that the message at 'failedOffset' is broken and the
+        // parsing restarts at 'syncOffset', returns negative to stop.
+        virtual int OnResync(
+            const field_info_env & env,
+            bit_size_t failedOffset,
+            bit_size_t syncOffset)
+        {
+            return 0;
+        }
     };
 
+    // Precompiles the dependencies of all the fields in the tree for the
+    // 'fieldDesDep' and numbers the fields (see field_des::FieldId()), so the
+    // parsing with it never looks up the table; invoke it again if the tree
+    // or the table is changed.
+    void FinalizeSchema(const field_des_dependency * fieldDesDep);
+
+    // The parsing state is kept in 'fieldInfoGen' (or a temporary one if it
+    // is 0) instead of the schema, so a schema can be parsed by the threads
+    // at once, each one with its own generator; the generator also keeps its
+    // buffers for the next parsing.
     // DON'T invoke this function in the implement of FieldSize() function.
     int ParseField(
         parse_callback * cb,
         const field_info_env & env,
-        uint32_t startOffset = 0
-    );
+        bit_size_t startOffset = 0,
+        field_info_generator * fieldInfoGen = 0
+    ) const;
+    // Parses the successive messages until the end of the buffer; each message
+    // should start with 'sync', and a broken message (a mismatched pattern, a
+    // negative callback result or a bad size) is skipped by searching the
+    // next pattern instead of aborting. Returns the count of parsed messages.
+    uint32_t ParseStream(
+        parse_callback * cb,
+        const field_info_env & env,
+        const sync_pattern & sync,
+        bit_size_t startOffset = 0,
+        field_info_generator * fieldInfoGen = 0
+    ) const;
+    // Parses at most 'maxMessages' (0 for no limit) back-to-back messages from
+    // 'startOffset' with the tree wrapper, the stacks & the generator kept for
+    // all of them, so it costs much less than one ParseField() per message
+    // for the small messages. It stops at the end of the buffer, a negative
+    // callback result or a message with a bad size, which is not counted;
+    // returns the count of parsed messages, and outputs the bits they take if
+    // 'out_parsedSize' is not 0.
+    uint32_t ParseMany(
+        parse_callback * cb,
+        const field_info_env & env,
+        bit_size_t startOffset = 0,
+        uint32_t maxMessages = 0,
+        field_info_generator * fieldInfoGen = 0,
+        bit_size_t * out_parsedSize = 0
+    ) const;
 
 private:
+    // The state of a parsing, which is NOT shared by the parsings.
     class parse_callback_invoker: public field_des_tree::for_each_callback {
-        combined_field_des * mParser;
         parse_callback * mCallback;
         field_info_env mEnv;
+        field_info_generator * mFieldInfoGen;
+        bit_size_t mParseOffset;
+        uint32_t mDepth; // of the current field, 0 for the root.
 
     public:
         parse_callback_invoker(
-            combined_field_des * parser,
             parse_callback * cb,
-            const field_info_env & env)
+            const field_info_env & env,
+            field_info_generator * fieldInfoGen,
+            bit_size_t startOffset)
         {
-            mParser = parser;
             mCallback = cb;
             mEnv = env;
+            mFieldInfoGen = fieldInfoGen;
+            mParseOffset = startOffset;
+            mDepth = 0;
+        }
+        bit_size_t ParseOffset() const {
+            return mParseOffset;
+        }
+        void Restart(bit_size_t startOffset) {
+            mParseOffset = startOffset;
+            mDepth = 0;
         }
         virtual void onPushStack(field_des_tree::stack_item * io_stackTop) {
-            // Do nothing.
+            ++mDepth;
         }
         virtual void afterPopStack(field_des_tree::stack_item * io_stackTop) {
+            --mDepth;
             if (io_stackTop->mNextSubNodeIdx == io_stackTop->mSubNodeCount) {
+                mFieldInfoGen->CloseScope(
+                    mEnv.mFieldDesDep, io_stackTop->mTreeNode->GetValue()
+                ); // the item is parsed.
                 if ( ++(io_stackTop->mData.mFieldNumber) < \
                     io_stackTop->mData.mMaxFieldNum )
                 {
@@ -466,21 +1229,29 @@ private:
             }
         }
         virtual int onTraversal(
-            field_des_tree::stack_item * io_stackTop, int order)
-        {
-            return mParser->invokeCallback(mCallback, mEnv, io_stackTop);
-        }
+            field_des_tree::stack_item * io_stackTop, int order
+        );
     };
     friend class combined_field_des::parse_callback_invoker;
 
-    uint32_t mParseOffset;
-    field_info_generator mFieldInfoGen;
+    class schema_finalizer;
+    friend class combined_field_des::schema_finalizer;
 
-    int invokeCallback(
+    static void finalizeField(
+        const field_des_dependency * fieldDesDep,
+        const field_des * fieldDes,
+        const field_des * parentFieldDes
+    );
+    static void finalizeScope(
+        const field_des_dependency * fieldDesDep, const field_des * fieldDes
+    );
+    int parseField(
         parse_callback * cb,
         const field_info_env & env,
-        field_des_tree::stack_item * io_stackTop
-    );
+        bit_size_t startOffset,
+        field_info_generator * fieldInfoGen,
+        bit_size_t * out_endOffset
+    ) const;
 };
 
 inline const combined_field_des * field_info::CombinedFieldDes() const {
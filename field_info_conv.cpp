@@ -86,7 +86,7 @@ void field_info_conv_traits_base::outputFieldBegin(
     const char * dividerAttr,
     const char * dividerVal)
 {
-    uint32_t metaInfo[] = {
+    bit_size_t metaInfo[] = {
         fieldInfo->MaxFieldNum(),
         fieldInfo->Offset(),
         fieldInfo->SizeInBit()
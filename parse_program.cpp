@@ -0,0 +1,835 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+
+#include <errno.h>
+#include <string.h>
+#include "parse_program.h"
+
+namespace pdl {
+
+uint32_t parse_program::emit(
+    uint32_t opCode, const field_des * fieldDes, uint32_t jumpPc)
+{
+    instruction inst;
+    inst.mOpCode = opCode;
+    inst.mJumpPc = jumpPc;
+    inst.mFieldDes = fieldDes;
+    inst.mIsDependency = false;
+    if (fieldDes) {
+        const field_des * const * depFieldDes = 0;
+        uint32_t depFieldCount = 0;
+        if ( !fieldDes->FinalizedDependency(
+                mFieldDesDep,
+                &depFieldDes,
+                &depFieldCount,
+                &(inst.mIsDependency) ) )
+        {
+            inst.mIsDependency = mFieldDesDep->FindWithA(fieldDes, 0) > 0;
+        }
+    }
+    mInstructions.push_back(inst);
+    return Size() - 1;
+}
+
+// The tree is compiled in the order of the pre-order traversal:
+//   ENTER_GROUP, GROUP_ITEM, <sub-fields>, LOOP_GROUP, EXIT_GROUP
+// the root is repeated by its count too, like ParseField().
+void parse_program::compileField(
+    field_des_tree::node_ptr_c treeNode, uint32_t depth)
+{
+    const field_des * fieldDes = treeNode->GetValue();
+    uint32_t subNodeCount = treeNode->GetSubNodeCount();
+    if (0 == subNodeCount) {
+        emit(OP_READ_LEAF, fieldDes);
+        return;
+    }
+    if (depth >= mMaxDepth)
+        mMaxDepth = depth + 1;
+    emit(OP_ENTER_GROUP, fieldDes);
+    uint32_t itemPc = emit(OP_GROUP_ITEM, fieldDes);
+    for (uint32_t i = 0; i < subNodeCount; ++i) {
+        field_des_tree::node_ptr_c subNode = treeNode->GetSubNode(i);
+        if (subNode)
+            compileField(subNode, depth + 1);
+    }
+    emit(OP_LOOP_GROUP, fieldDes, itemPc);
+    mInstructions[itemPc].mJumpPc = emit(OP_EXIT_GROUP, fieldDes);
+}
+
+bool parse_program::Compile(
+    const combined_field_des * fieldDes,
+    const field_des_dependency * fieldDesDep)
+{
+    mInstructions.resize(0);
+    mFieldDesDep = fieldDesDep;
+    mMaxDepth = 0;
+    if ( fieldDes && fieldDesDep && fieldDes->IsCombined() ) {
+        compileField(fieldDes->TreeNode(), 0);
+        emit(OP_END, 0);
+        return true;
+    }
+    PDL_THROW( std::invalid_argument(
+        "parse_program::Compile() invalid argument!"
+    ) );
+    return false;
+}
+
+int parse_program::Run(
+    combined_field_des::parse_callback * cb,
+    const field_info_env & env,
+    bit_size_t startOffset,
+    field_info_generator * fieldInfoGen,
+    bit_size_t * out_endOffset) const
+{
+    if ( !env.mFieldDesDep || env.mFieldDesDep != mFieldDesDep || \
+         !env.mBuf || startOffset > bit_ref::BitsOf( env.mBuf->Size() ) )
+    {
+        PDL_THROW( std::invalid_argument(
+            "parse_program::Run() invalid argument!"
+        ) );
+        return (EINVAL < 0)? EINVAL: -EINVAL;
+    }
+    // The context uses no own generator and allocates only its frames.
+    field_info_generator tempFieldInfoGen;
+    stream_parse_ctx ctx(
+        this, env, startOffset, fieldInfoGen? fieldInfoGen: &tempFieldInfoGen
+    );
+    int cbResult = ctx.Parse(cb, true);
+    if (out_endOffset)
+        *out_endOffset = ctx.ParseOffset();
+    return cbResult;
+}
+
+stream_parse_ctx::stream_parse_ctx(
+    const parse_program * program,
+    const field_info_env & env,
+    bit_size_t startOffset,
+    field_info_generator * fieldInfoGen)
+{
+    mProgram = program;
+    mEnv = env;
+    mOwnFieldInfoGen = fieldInfoGen? 0: new field_info_generator;
+    mFieldInfoGen = fieldInfoGen? fieldInfoGen: mOwnFieldInfoGen;
+    if (program)
+        mFrames.reserve(program->mMaxDepth);
+    mPc = 0;
+    mParseOffset = startOffset;
+    mNeededBytes = 0;
+    mResult = 0;
+    mIsFinished = false;
+}
+
+void stream_parse_ctx::Restart(bit_size_t startOffset) {
+    if (!mIsFinished)
+        mFieldInfoGen->Reset();
+    mFrames.resize(0);
+    mPc = 0;
+    mParseOffset = startOffset;
+    mNeededBytes = 0;
+    mResult = 0;
+    mIsFinished = false;
+}
+
+buf_size_t stream_parse_ctx::DropParsed() {
+    if ( !mIsFinished || !mEnv.mBuf )
+        return 0;
+    buf_size_t size = mEnv.mBuf->Size();
+    buf_size_t dropped = static_cast<buf_size_t>(mParseOffset >> 3);
+    if (dropped > size)
+        dropped = size;
+    if (0 == dropped)
+        return 0;
+    uint8_t * data = static_cast<uint8_t *>( mEnv.mBuf->Buf() );
+    if ( mEnv.mBuf->IsReadOnly() ) {
+        const uint8_t * roData = data;
+        mEnv.mBuf->Attach(roData + dropped, size - dropped);
+    } else if ( mEnv.mBuf->IsAttached() ) // the external memory is NOT modified.
+        mEnv.mBuf->Attach(data + dropped, size - dropped);
+    else {
+        memmove(data, data + dropped, size - dropped);
+        mEnv.mBuf->Resize(size - dropped);
+    }
+    mParseOffset -= bit_ref::BitsOf(dropped);
+    return dropped;
+}
+
+void stream_parse_ctx::Append(const void * data, buf_size_t size) {
+    if (mEnv.mBuf && data && size) {
+        buf_size_t oldSize = mEnv.mBuf->Size();
+        mEnv.mBuf->Resize(oldSize + size);
+        if ( mEnv.mBuf->Size() == oldSize + size ) {
+            uint8_t * buf = static_cast<uint8_t *>( mEnv.mBuf->Buf() );
+            memcpy(buf + oldSize, data, size);
+        }
+    }
+}
+
+// Records the bytes needed for the buffer to hold 'neededSize' bits.
+int stream_parse_ctx::suspend(bit_size_t neededSize) {
+    buf_size_t bufSize = mEnv.mBuf->Size();
+    bit_size_t neededBytes = (neededSize + 7) >> 3;
+    mNeededBytes = (neededBytes > bufSize)? \
+        static_cast<buf_size_t>(neededBytes - bufSize): 1;
+    return 1;
+}
+
+// Returns 0 if all the items of 'range' are in the buffer, or the size (in
+// bit) the buffer needs at least: an item of 0 size needs more data to get the
+// size, and an item beyond the buffer needs the data up to its end.
+bit_size_t stream_parse_ctx::neededEnd(const field_info_range & range) const {
+    bit_size_t dataSize = bit_ref::BitsOf( mEnv.mBuf->Size() );
+    if ( range.IsConstSize() )
+        return (range.EndOffset() > dataSize)? range.EndOffset(): 0;
+    field_info_ctx item;
+    for (uint32_t i = 0; range.ItemAt(i, &item); ++i) {
+        if (0 == item.mFieldSize)
+            return dataSize + 1;
+        if (item.mFieldOffset + item.mFieldSize > dataSize)
+            return item.mFieldOffset + item.mFieldSize;
+    }
+    return 0;
+}
+
+// Computes the provisional size of the open item of the innermost combined
+// field again, and pushes it to the backtrace again if it is a dependency;
+// suspends (returns > 0 with mPc unchanged) if the size is still unknown.
+int stream_parse_ctx::closeItem(
+    const parse_program::instruction & inst, bool endOfData)
+{
+    obj_ptr<field_info> & item = mFrames.back().mOpenItem;
+    if (!item)
+        return 0;
+    bit_size_t dataSize = bit_ref::BitsOf( mEnv.mBuf->Size() );
+    if ( 0 == mFieldInfoGen->RefreshFieldSize(
+            mEnv, item, endOfData? 0: dataSize - item->Offset() ) && \
+         !endOfData )
+    {
+        return suspend(dataSize + 1);
+    }
+    if (inst.mIsDependency)
+        mFieldInfoGen->PushBacktraceItem(item, mEnv.mBuf);
+    item = obj_ptr<field_info>();
+    return 0;
+}
+
+// Works like the leaf part of the parse_callback_invoker of ParseField(), but
+// suspends (returns > 0 with mPc unchanged) if the items are not all in the
+// buffer.
+int stream_parse_ctx::readLeaf(
+    const parse_program::instruction & inst,
+    combined_field_des::parse_callback * cb,
+    uint32_t lazyArrayThreshold,
+    bool endOfData)
+{
+    if ( !endOfData && mParseOffset >= bit_ref::BitsOf( mEnv.mBuf->Size() ) )
+        return suspend(mParseOffset + 1);
+    field_info_ctx args(inst.mFieldDes, mParseOffset, 1);
+    field_info_range range;
+    if ( !mFieldInfoGen->CreateFieldInfoRange(mEnv, &args, &range) ) {
+        ++mPc;
+        return 0;
+    }
+    bit_size_t needed = endOfData? 0: neededEnd(range);
+    if (needed)
+        return suspend(needed);
+    ++mPc;
+    int cbResult = 0;
+    if ( lazyArrayThreshold && range.Count() >= lazyArrayThreshold ) {
+        cbResult = cb->ArrayCallback(mEnv, range);
+        if (cbResult >= 0) {
+            if (inst.mIsDependency)
+                mFieldInfoGen->PushBacktraceItem(args, mEnv.mBuf);
+            mParseOffset = range.EndOffset();
+        }
+        return (cbResult > 0)? 0: cbResult;
+    }
+    obj_ptr<field_info> fieldInfo = mFieldInfoGen->CreateFieldInfo(range);
+    cbResult = cb->Callback(mEnv, fieldInfo);
+    if (cbResult >= 0) {
+        if (inst.mIsDependency)
+            mFieldInfoGen->PushBacktraceItem(fieldInfo, mEnv.mBuf);
+        const field_info & lastFieldInfo = \
+            fieldInfo[fieldInfo->ItemCount() - 1];
+        mParseOffset = lastFieldInfo.Offset() + lastFieldInfo.SizeInBit();
+    }
+    // NOTE: a positive result is ignored (see the parse_program).
+    return (cbResult > 0)? 0: cbResult;
+}
+
+int stream_parse_ctx::Parse(
+    combined_field_des::parse_callback * cb, bool endOfData)
+{
+    if (mIsFinished)
+        return mResult;
+    if ( !cb || !mProgram || mProgram->mInstructions.empty() || \
+         !mEnv.mFieldDesDep || mEnv.mFieldDesDep != mProgram->mFieldDesDep || \
+         !mEnv.mBuf || mParseOffset > bit_ref::BitsOf( mEnv.mBuf->Size() ) )
+    {
+        PDL_THROW( std::invalid_argument(
+            "stream_parse_ctx::Parse() invalid argument!"
+        ) );
+        return (EINVAL < 0)? EINVAL: -EINVAL;
+    }
+    mNeededBytes = 0;
+    uint32_t lazyArrayThreshold = cb->LazyArrayThreshold();
+    const parse_program::instruction * code = \
+        &(mProgram->mInstructions[0]);
+    int cbResult = 0;
+    while (cbResult >= 0) {
+        const parse_program::instruction & inst = code[mPc];
+        switch (inst.mOpCode) {
+        case parse_program::OP_ENTER_GROUP:
+            mFrames.push_back( frame() );
+            ++mPc;
+            continue;
+        case parse_program::OP_GROUP_ITEM: {
+            if ( !endOfData && \
+                 mParseOffset >= bit_ref::BitsOf( mEnv.mBuf->Size() ) )
+            {
+                return suspend(mParseOffset + 1);
+            }
+            frame & curFrame = mFrames.back();
+            field_info_ctx args(
+                inst.mFieldDes, mParseOffset, curFrame.mFieldNumber + 1
+            );
+            field_info_range range;
+            if ( !mFieldInfoGen->CreateFieldInfoRange(mEnv, &args, &range) ) {
+                mPc = inst.mJumpPc;
+                continue;
+            }
+            // The root is checked once like ParseField(), if the whole message
+            // is buffered.
+            if ( endOfData && 1 == mFrames.size() )
+                mFieldInfoGen->CheckMessage(mEnv, &range);
+            obj_ptr<field_info> fieldInfo = \
+                mFieldInfoGen->CreateFieldInfo(range);
+            ++mPc;
+            curFrame.mMaxFieldNum = args.mMaxFieldNum;
+            // The item is opened without waiting for all its bits, the size
+            // which needs more data is provisional until closeItem().
+            if ( endOfData || fieldInfo->SizeInBit() )
+                curFrame.mOpenItem = obj_ptr<field_info>();
+            else {
+                mFieldInfoGen->RefreshFieldSize(
+                    mEnv,
+                    fieldInfo,
+                    bit_ref::BitsOf( mEnv.mBuf->Size() ) - mParseOffset
+                );
+                curFrame.mOpenItem = fieldInfo;
+            }
+            cbResult = cb->Callback(mEnv, fieldInfo);
+            if (cbResult >= 0 && inst.mIsDependency)
+                mFieldInfoGen->PushBacktraceItem(fieldInfo, mEnv.mBuf);
+            if (cbResult > 0) { // ignores the sub-fields.
+                cbResult = 0;
+                mPc = inst.mJumpPc;
+            }
+            continue;
+        }
+        case parse_program::OP_READ_LEAF:
+            cbResult = readLeaf(inst, cb, lazyArrayThreshold, endOfData);
+            if (cbResult > 0)
+                return cbResult; // suspended.
+            continue;
+        case parse_program::OP_LOOP_GROUP: {
+            cbResult = closeItem(inst, endOfData);
+            if (cbResult > 0)
+                return cbResult; // suspended.
+            frame & curFrame = mFrames.back();
+            mFieldInfoGen->CloseScope(mEnv.mFieldDesDep, inst.mFieldDes);
+            if (++curFrame.mFieldNumber < curFrame.mMaxFieldNum)
+                mPc = inst.mJumpPc;
+            else
+                ++mPc;
+            continue;
+        }
+        case parse_program::OP_EXIT_GROUP:
+            cbResult = closeItem(inst, endOfData); // the skipped item.
+            if (cbResult > 0)
+                return cbResult; // suspended.
+            mFrames.pop_back();
+            ++mPc;
+            continue;
+        }
+        break; // OP_END.
+    }
+    mFieldInfoGen->Reset();
+    mResult = cbResult;
+    mIsFinished = true;
+    return cbResult;
+}
+
+} // namespace pdl
+
+#ifdef PARSE_PROGRAM_UT
+#include <iostream>
+#include <time.h>
+
+using namespace pdl;
+
+// The count of the field is the value of the field it depends on, or 1.
+static uint32_t testFieldCount(
+    const field_info_ctx * depFieldInfo, uint32_t depFieldInfoCount)
+{
+    return (1 == depFieldInfoCount && depFieldInfo[0].mIsDecoded) \
+        ? static_cast<uint32_t>(depFieldInfo[0].mDecodedVal): 1;
+}
+
+class test_uint_field: public leaf_field_des {
+    const char * mName;
+    uint32_t mSize;
+
+public:
+    test_uint_field(const char * name, uint32_t size) {
+        mName = name;
+        mSize = size;
+    }
+    virtual const char * FieldName() const {
+        return mName;
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return testFieldCount(depFieldInfo, depFieldInfoCount);
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return mSize;
+    }
+    virtual bit_size_t ConstFieldSize() const {
+        return mSize;
+    }
+    virtual bool DecodeField(bit_ref bitRef, value_obj * out_val) const {
+        uint64_t val = 0;
+        if ( DecodeInt(bitRef, &val) ) {
+            out_val->Reset();
+            val_itf_selector<int_val>::GetInterface(out_val)->Val() = \
+                static_cast<uint32_t>(val);
+            return true;
+        }
+        return false;
+    }
+    virtual bool EncodeField(bit_ref bitRef, const value_obj * val) const {
+        return false;
+    }
+    virtual bool DecodeInt(bit_ref bitRef, uint64_t * out_val) const {
+        unchecked_bit_ref bits;
+        if ( out_val && bitRef.Unchecked(mSize, &bits) ) {
+            *out_val = bits.ReadUInt(mSize);
+            return true;
+        }
+        return false;
+    }
+};
+
+// The size (in bit) of the record at 'data', or 0 if it is truncated.
+static bit_size_t recSize(const uint8_t * data, buf_size_t size) {
+    return size? bit_ref::BitsOf(3 + data[0]): 0;
+}
+
+// The size (in bit) of the message at 'data', or 0 if it is truncated.
+static bit_size_t msgSize(const uint8_t * data, buf_size_t size) {
+    if (size < 2)
+        return 0;
+    uint32_t recCount = (uint32_t(data[0]) << 8) | data[1];
+    buf_size_t pos = 2;
+    for (uint32_t i = 0; i < recCount; ++i) {
+        if (pos >= size)
+            return 0;
+        pos += 3 + data[pos];
+    }
+    return (pos > size)? 0: bit_ref::BitsOf(pos);
+}
+
+// The size (in bit) of the rest of the buffer.
+static bit_size_t restSize(const uint8_t * data, buf_size_t size) {
+    return bit_ref::BitsOf(size);
+}
+
+class test_group_field: public combined_field_des {
+    typedef bit_size_t (*size_func)(const uint8_t * data, buf_size_t size);
+    const char * mName;
+    size_func mSizeFunc;
+
+public:
+    test_group_field(const char * name, size_func sizeFunc) {
+        mName = name;
+        mSizeFunc = sizeFunc;
+    }
+    virtual const char * FieldName() const {
+        return mName;
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return testFieldCount(depFieldInfo, depFieldInfoCount);
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        buf_size_t pos = static_cast<buf_size_t>(bitRef.Offset() >> 3);
+        const buf_val * buf = bitRef.Buf();
+        return (buf && pos <= buf->Size())? mSizeFunc(
+            static_cast<const uint8_t *>( buf->Buf() ) + pos,
+            buf->Size() - pos
+        ): 0;
+    }
+};
+
+// Digests the sequence of the fields, the offsets are added by 'mBaseOffset'
+// for the buffer which drops the parsed data; the sizes of the combined fields
+// are digested by FoldGroups() after the items are closed, since they may be
+// provisional in the callbacks of a stream_parse_ctx.
+struct digest_callback: combined_field_des::parse_callback {
+    uint64_t mDigest;
+    uint64_t mGroupDigest;
+    uint32_t mFieldCount;
+    uint32_t mCheckedCount; // the fields created as checked.
+    bit_size_t mBaseOffset;
+    std::vector< obj_ptr<field_info> > mGroups;
+
+    digest_callback() {
+        mDigest = 0;
+        mGroupDigest = 0;
+        mFieldCount = 0;
+        mCheckedCount = 0;
+        mBaseOffset = 0;
+    }
+    void digest(
+        const field_des * fieldDes,
+        bit_size_t offset,
+        bit_size_t size,
+        uint32_t n)
+    {
+        mDigest = mDigest * 31 + fieldDes->FieldId();
+        mDigest = mDigest * 31 + mBaseOffset + offset;
+        mDigest = mDigest * 31 + size;
+        mDigest = mDigest * 31 + n;
+        mFieldCount += n;
+    }
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        bool isGroup = fieldInfo->FieldDes()->IsCombined();
+        if (isGroup)
+            mGroups.push_back(fieldInfo);
+        if ( fieldInfo->IsChecked() )
+            ++mCheckedCount;
+        digest(
+            fieldInfo->FieldDes(),
+            fieldInfo->Offset(),
+            isGroup? 0: fieldInfo->SizeInBit(),
+            fieldInfo->ItemCount()
+        );
+        return 0;
+    }
+    void FoldGroups() {
+        for (uint32_t i = 0; i < mGroups.size(); ++i)
+            mGroupDigest = mGroupDigest * 31 + mGroups[i]->SizeInBit();
+        mGroups.clear();
+    }
+    uint64_t Digest() {
+        FoldGroups();
+        return mDigest * 31 + mGroupDigest;
+    }
+};
+
+struct digest_range_callback: digest_callback {
+    virtual uint32_t LazyArrayThreshold() const {
+        return 2;
+    }
+    virtual int ArrayCallback(
+        const field_info_env & env, const field_info_range & range)
+    {
+        digest(
+            range.FieldDes(),
+            range.Offset(),
+            range.EndOffset() - range.Offset(),
+            range.Count()
+        );
+        return 0;
+    }
+};
+
+// Records the sequence of the fields, and returns 1 for 'mPositiveFieldDes'.
+struct record_callback: combined_field_des::parse_callback {
+    std::vector<const field_des *> mFieldDes;
+    std::vector<bit_size_t> mOffsets;
+    const field_des * mPositiveFieldDes;
+
+    explicit record_callback(const field_des * positiveFieldDes = 0) {
+        mPositiveFieldDes = positiveFieldDes;
+    }
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        mFieldDes.push_back( fieldInfo->FieldDes() );
+        mOffsets.push_back( fieldInfo->Offset() );
+        return (fieldInfo->FieldDes() == mPositiveFieldDes)? 1: 0;
+    }
+    bool IsSequence(
+        const field_des * const * fieldDes,
+        const bit_size_t * offsets,
+        uint32_t count) const
+    {
+        if (mFieldDes.size() != count)
+            return false;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (mFieldDes[i] != fieldDes[i] || mOffsets[i] != offsets[i])
+                return false;
+        }
+        return true;
+    }
+};
+
+static field_des_tree::node_ptr bindNode(
+    field_des * fieldDes, uint32_t subNodeCount)
+{
+    field_des_tree::node_ptr node = field_des_tree::CreateNode(fieldDes);
+    fieldDes->BindTreeNode(node);
+    if (subNodeCount)
+        node->SetSubNodeCapacity(subNodeCount);
+    return node;
+}
+
+static double elapsedMs(clock_t start) {
+    return double( clock() - start ) * 1000 / CLOCKS_PER_SEC;
+}
+
+int main() {
+    // msg { rec_count, rec[rec_count] { rec_len, rec_data[rec_len], rec_tag } }
+    const uint32_t REC_COUNT = 20000;
+    test_group_field msg("msg", msgSize);
+    test_uint_field recCount("rec_count", 16);
+    test_group_field rec("rec", recSize);
+    test_uint_field recLen("rec_len", 8);
+    test_uint_field recData("rec_data", 8);
+    test_uint_field recTag("rec_tag", 16);
+    field_des_tree::node_ptr msgNode = bindNode(&msg, 2);
+    field_des_tree::node_ptr recNode = bindNode(&rec, 3);
+    msgNode->SetSubNode( 0, bindNode(&recCount, 0) );
+    msgNode->SetSubNode(1, recNode);
+    recNode->SetSubNode( 0, bindNode(&recLen, 0) );
+    recNode->SetSubNode( 1, bindNode(&recData, 0) );
+    recNode->SetSubNode( 2, bindNode(&recTag, 0) );
+    field_des_tree msgTree(msgNode); // to delete nodes.
+    field_des_dependency fieldDesDep;
+    fieldDesDep.Insert(&recCount, &rec);
+    fieldDesDep.Insert(&recLen, &recData);
+    msg.FinalizeSchema(&fieldDesDep);
+
+    std::vector<uint8_t> data;
+    data.push_back( uint8_t(REC_COUNT >> 8) );
+    data.push_back( uint8_t(REC_COUNT) );
+    for (uint32_t i = 0; i < REC_COUNT; ++i) {
+        uint8_t len = uint8_t(i % 7 + 1);
+        data.push_back(len);
+        data.insert( data.end(), len, uint8_t(i) );
+        data.push_back( uint8_t(i >> 8) );
+        data.push_back( uint8_t(i) );
+    }
+    field_info_span_env env( &fieldDesDep, &(data[0]), data.size() );
+
+    parse_program program;
+    bool ok = program.Compile(&msg, &fieldDesDep) && \
+        program.At(0).mOpCode == parse_program::OP_ENTER_GROUP && \
+        program.At(program.Size() - 1).mOpCode == parse_program::OP_END;
+
+    // The same fields (& the same lazy arrays) as the tree walker, which are
+    // checked once by the message too.
+    field_info_generator fieldInfoGen;
+    digest_callback treeCb, programCb;
+    digest_range_callback treeRangeCb, programRangeCb;
+    bit_size_t endOffset = 0;
+    msg.ParseField(&treeCb, env, 0, &fieldInfoGen);
+    msg.ParseField(&treeRangeCb, env, 0, &fieldInfoGen);
+    ok = ok && \
+        0 == program.Run(&programCb, env, 0, &fieldInfoGen, &endOffset) && \
+        treeCb.Digest() == programCb.Digest() && \
+        treeCb.mFieldCount == programCb.mFieldCount && \
+        treeCb.mCheckedCount == programCb.mCheckedCount && \
+        programCb.mCheckedCount > 0 && \
+        endOffset == bit_ref::BitsOf( data.size() ) && \
+        0 == program.Run(&programRangeCb, env, 0, &fieldInfoGen) && \
+        treeRangeCb.Digest() == programRangeCb.Digest() && \
+        treeRangeCb.mFieldCount == programRangeCb.mFieldCount;
+
+    // The messages of 1 ~ 5 records fed in the chunks of 1 ~ 61 bytes get the
+    // same fields (& sizes) as ParseMany(), with each finished message dropped
+    // from the buffer; the fields are parsed as their bits arrive (the size of
+    // a message is provisional until all its records are parsed), so each
+    // suspension asks for the bytes of a leaf (7 at most) and the fields of a
+    // message are passed to the callback before the message is buffered.
+    const uint32_t MSG_COUNT = 500;
+    std::vector<uint8_t> stream;
+    for (uint32_t i = 0; i < MSG_COUNT; ++i) {
+        uint32_t recCount = i % 5 + 1;
+        stream.push_back(0);
+        stream.push_back( uint8_t(recCount) );
+        for (uint32_t j = 0; j < recCount; ++j) {
+            uint8_t len = uint8_t( (i + j) % 7 + 1 );
+            stream.push_back(len);
+            stream.insert( stream.end(), len, uint8_t(j) );
+            stream.push_back( uint8_t(i >> 8) );
+            stream.push_back( uint8_t(i) );
+        }
+    }
+    field_info_span_env manyEnv( &fieldDesDep, &(stream[0]), stream.size() );
+    digest_range_callback manyCb;
+    ok = ok && MSG_COUNT == msg.ParseMany(
+        &manyCb, manyEnv, 0, 0, &fieldInfoGen
+    );
+    buf_val streamBuf;
+    field_info_env streamEnv = { &fieldDesDep, &streamBuf };
+    stream_parse_ctx streamCtx(&program, streamEnv);
+    digest_range_callback streamCb;
+    buf_size_t fedSize = 0;
+    buf_size_t maxBufSize = 0;
+    uint32_t msgCount = 0;
+    uint32_t suspendCount = 0;
+    uint32_t partialCount = 0; // the suspensions after some fields parsed.
+    while (ok && msgCount < MSG_COUNT) {
+        uint32_t fieldCount = streamCb.mFieldCount;
+        int streamResult = streamCtx.Parse(
+            &streamCb, fedSize == stream.size()
+        );
+        if (streamResult > 0) {
+            if (streamCb.mFieldCount > fieldCount)
+                ++partialCount;
+            buf_size_t chunkSize = (suspendCount++ * 7) % 61 + 1;
+            if (chunkSize > stream.size() - fedSize)
+                chunkSize = static_cast<buf_size_t>( stream.size() - fedSize );
+            ok = streamCtx.NeededBytes() > 0 && \
+                streamCtx.NeededBytes() <= 7;
+            streamCtx.Append(&(stream[fedSize]), chunkSize);
+            fedSize += chunkSize;
+            if ( streamBuf.Size() > maxBufSize )
+                maxBufSize = streamBuf.Size();
+        } else if (0 == streamResult && streamCtx.IsFinished() ) {
+            ++msgCount;
+            streamCb.FoldGroups();
+            streamCb.mBaseOffset += bit_ref::BitsOf( streamCtx.DropParsed() );
+            ok = streamCtx.ParseOffset() == 0;
+            streamCtx.Restart( streamCtx.ParseOffset() );
+        } else
+            ok = false;
+    }
+    ok = ok && suspendCount > MSG_COUNT / 2 && maxBufSize < 52 + 61 && \
+        partialCount > MSG_COUNT / 2 && \
+        fedSize == stream.size() && streamBuf.Size() == 0 && \
+        manyCb.Digest() == streamCb.Digest() && \
+        manyCb.mFieldCount == streamCb.mFieldCount;
+
+    // The attached memory is only re-attached by DropParsed().
+    buf_val attachedBuf;
+    attachedBuf.Attach( &(stream[0]), stream.size() );
+    field_info_env attachedEnv = { &fieldDesDep, &attachedBuf };
+    stream_parse_ctx attachedCtx(&program, attachedEnv);
+    digest_callback attachedCb;
+    ok = ok && 0 == attachedCtx.Parse(&attachedCb) && \
+        attachedCtx.DropParsed() == 2 + 4 && \
+        attachedBuf.Buf() == &(stream[2 + 4]) && \
+        attachedBuf.Size() == stream.size() - (2 + 4) && \
+        attachedCtx.ParseOffset() == 0;
+
+    // Where the program differs from the tree walker: an empty leaf is
+    // skipped, and a positive result of a leaf is ignored, so the next fields
+    // are parsed at the offsets after the previous ones.
+    // opt_msg { opt_len, opt_data[opt_len], opt_tail }
+    test_group_field optMsg("opt_msg", restSize);
+    test_uint_field optLen("opt_len", 8);
+    test_uint_field optData("opt_data", 8);
+    test_uint_field optTail("opt_tail", 8);
+    field_des_tree::node_ptr optMsgNode = bindNode(&optMsg, 3);
+    optMsgNode->SetSubNode( 0, bindNode(&optLen, 0) );
+    optMsgNode->SetSubNode( 1, bindNode(&optData, 0) );
+    optMsgNode->SetSubNode( 2, bindNode(&optTail, 0) );
+    field_des_tree optMsgTree(optMsgNode); // to delete nodes.
+    field_des_dependency optFieldDesDep;
+    optFieldDesDep.Insert(&optLen, &optData);
+    optMsg.FinalizeSchema(&optFieldDesDep);
+    parse_program optProgram;
+    ok = ok && optProgram.Compile(&optMsg, &optFieldDesDep);
+
+    uint8_t emptyData[] = {0x00, 0x5a};
+    field_info_span_env emptyEnv(
+        &optFieldDesDep, emptyData, sizeof(emptyData)
+    );
+    const field_des * emptyFields[] = {&optMsg, &optLen, &optTail};
+    const bit_size_t emptyOffsets[] = {0, 0, 8};
+    record_callback emptyCb;
+    ok = ok && \
+        0 == optProgram.Run(&emptyCb, emptyEnv, 0, 0, &endOffset) && \
+        emptyCb.IsSequence(emptyFields, emptyOffsets, 3) && \
+        endOffset == 16;
+
+    uint8_t positiveData[] = {0x01, 0x11, 0x5a};
+    field_info_span_env positiveEnv(
+        &optFieldDesDep, positiveData, sizeof(positiveData)
+    );
+    const field_des * positiveFields[] = {&optMsg, &optLen, &optData, &optTail};
+    const bit_size_t positiveOffsets[] = {0, 0, 8, 16};
+    record_callback positiveCb(&optLen);
+    ok = ok && \
+        0 == optProgram.Run(&positiveCb, positiveEnv, 0, 0, &endOffset) && \
+        positiveCb.IsSequence(positiveFields, positiveOffsets, 4) && \
+        endOffset == 24;
+
+    // The benchmark of the dispatch loop against the tree walk: both runs use
+    // the same callback & generator over the same 20000 records, so the time
+    // difference is the cost of traversing the schema; each timed run should
+    // parse all the fields, but the timings are only printed since they vary
+    // with the machine.
+    const uint32_t LOOP_COUNT = 20;
+    clock_t start = clock();
+    for (uint32_t i = 0; i < LOOP_COUNT; ++i) {
+        digest_range_callback cb;
+        msg.ParseField(&cb, env, 0, &fieldInfoGen);
+        ok = ok && cb.Digest() == treeRangeCb.Digest();
+    }
+    double treeMs = elapsedMs(start);
+    start = clock();
+    for (uint32_t i = 0; i < LOOP_COUNT; ++i) {
+        digest_range_callback cb;
+        program.Run(&cb, env, 0, &fieldInfoGen);
+        ok = ok && cb.Digest() == treeRangeCb.Digest();
+    }
+    double programMs = elapsedMs(start);
+    std::cout << LOOP_COUNT << " x " << treeCb.mFieldCount << \
+        " fields: tree walker " << treeMs << " ms, parse program " << \
+        programMs << " ms." << std::endl;
+
+    std::cout << \
+        (ok? "parse_program test passed.": "parse_program test failed!") << \
+        std::endl;
+    return ok? 0: 1;
+}
+#endif // PARSE_PROGRAM_UT
@@ -0,0 +1,188 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+
+#ifndef _PARSE_PROGRAM_H_
+#define _PARSE_PROGRAM_H_
+
+#ifndef __cplusplus
+#error The module is NOT compatible with C codes.
+#endif
+
+#include "field_des.h"
+
+namespace pdl {
+
+// The schema compiled into the flat instructions for a dispatch loop, which
+// parses like ParseField() without walking the tree.
+// NOTE: a positive result of a leaf callback is ignored and an empty leaf is
+// skipped, while ParseField() re-enters the sub-fields of the parent.
+class parse_program {
+public:
+    enum op_code {
+        OP_ENTER_GROUP, // pushes the item counter of a combined field.
+        OP_GROUP_ITEM, // jumps to mJumpPc if there is no item or it is skipped.
+        OP_READ_LEAF, // parses all the items of a leaf field.
+        OP_LOOP_GROUP, // closes the item, jumps to mJumpPc for the next one.
+        OP_EXIT_GROUP, // pops the item counter.
+        OP_END
+    };
+
+    struct instruction {
+        uint32_t mOpCode;
+        uint32_t mJumpPc;
+        const field_des * mFieldDes;
+        bool mIsDependency;
+    };
+
+private:
+    typedef std_allocator<instruction,field_info> instruction_allocator;
+    typedef std::vector<instruction,instruction_allocator> instruction_buf;
+
+    friend class stream_parse_ctx;
+
+    instruction_buf mInstructions;
+    const field_des_dependency * mFieldDesDep;
+    uint32_t mMaxDepth;
+
+    uint32_t emit(
+        uint32_t opCode, const field_des * fieldDes, uint32_t jumpPc = 0
+    );
+    void compileField(field_des_tree::node_ptr_c treeNode, uint32_t depth);
+
+public:
+    parse_program() {
+        mFieldDesDep = 0;
+        mMaxDepth = 0;
+    }
+
+    // Compiles the tree of 'fieldDes' for 'fieldDesDep', returns false if the
+    // field is not the root of a tree; compile it again if the tree or the
+    // table is changed.
+    bool Compile(
+        const combined_field_des * fieldDes,
+        const field_des_dependency * fieldDesDep
+    );
+    uint32_t Size() const {
+        return static_cast<uint32_t>( mInstructions.size() );
+    }
+    const instruction & At(uint32_t pc) const {
+        return mInstructions[pc];
+    }
+    // Works like combined_field_des::ParseField(), and outputs the offset
+    // after the last parsed field if 'out_endOffset' is not 0; the 'env' should
+    // be with the field_des_dependency which the program is compiled for.
+    int Run(
+        combined_field_des::parse_callback * cb,
+        const field_info_env & env,
+        bit_size_t startOffset = 0,
+        field_info_generator * fieldInfoGen = 0,
+        bit_size_t * out_endOffset = 0
+    ) const;
+};
+
+// The resumable execution of a parse_program over the data which arrives chunk
+// by chunk, every field is parsed only once.
+// NOTE: the FieldCount() & FieldSize() should return 0 rather than read beyond
+// the buffer, and the count of a combined field should come from the leaves.
+class stream_parse_ctx {
+    // The item counter of a combined field, with its open item if the size
+    // of the item is provisional, or empty.
+    struct frame: field_des_tree_stack_data {
+        obj_ptr<field_info> mOpenItem;
+    };
+    typedef std_allocator<frame,field_info> frame_allocator;
+    typedef std::vector<frame,frame_allocator> frame_buf;
+
+    const parse_program * mProgram;
+    field_info_env mEnv;
+    field_info_generator * mFieldInfoGen;
+    field_info_generator * mOwnFieldInfoGen; // only if none is given.
+    frame_buf mFrames;
+    uint32_t mPc;
+    bit_size_t mParseOffset;
+    buf_size_t mNeededBytes;
+    int mResult; // the result of the finished parsing.
+    bool mIsFinished;
+
+    stream_parse_ctx(const stream_parse_ctx &); // non-copyable.
+    stream_parse_ctx & operator =(const stream_parse_ctx &);
+
+    int suspend(bit_size_t neededSize);
+    bit_size_t neededEnd(const field_info_range & range) const;
+    int closeItem(const parse_program::instruction & inst, bool endOfData);
+    int readLeaf(
+        const parse_program::instruction & inst,
+        combined_field_des::parse_callback * cb,
+        uint32_t lazyArrayThreshold,
+        bool endOfData
+    );
+
+public:
+    // The 'program', the 'env' (a copy is kept, but not the buffer) and the
+    // 'fieldInfoGen' (an own one is used if it is 0) should be alive until the
+    // context is destroyed.
+    stream_parse_ctx(
+        const parse_program * program,
+        const field_info_env & env,
+        bit_size_t startOffset = 0,
+        field_info_generator * fieldInfoGen = 0
+    );
+    ~stream_parse_ctx() {
+        delete mOwnFieldInfoGen;
+    }
+
+    // Starts the parsing of another message at 'startOffset'.
+    void Restart(bit_size_t startOffset);
+    // Drops the whole bytes before ParseOffset() from the buffer after the
+    // message is finished (the attached memory is only re-attached), and
+    // rebases ParseOffset(), returns the count of dropped bytes; the bytes are
+    // kept during a message since the backtrace refers them by the offsets.
+    buf_size_t DropParsed();
+    // Appends the data to the buffer of the env.
+    void Append(const void * data, buf_size_t size);
+    // Parses the fields in the buffer from where it was suspended, never
+    // suspends if 'endOfData' is true. A leaf is parsed once all its bits are
+    // buffered, and an item of a combined field once its 1st. bit is; the
+    // item gets the size of the buffered bits if its size is unknown, which
+    // is computed again when it is closed. Return value:
+    //   > 0 - suspended, at least NeededBytes() more bytes are needed;
+    //   0 - the message is parsed;
+    //   < 0 - stopped by a callback or an error, like ParseField().
+    // The result of the finished parsing is returned until Restart().
+    int Parse(combined_field_des::parse_callback * cb, bool endOfData = false);
+    // The bytes to append before the next Parse(), a field with no bit in the
+    // buffer (e.g. an empty field at the end) waits for 1 more byte.
+    buf_size_t NeededBytes() const {
+        return mNeededBytes;
+    }
+    // The offset after the last parsed field.
+    bit_size_t ParseOffset() const {
+        return mParseOffset;
+    }
+    bool IsFinished() const {
+        return mIsFinished;
+    }
+};
+
+} // namespace pdl
+
+#endif // _PARSE_PROGRAM_H_
@@ -18,6 +18,7 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE. */
 
+#include <stddef.h>
 #include "value_obj.h"
 
 using namespace pdl;
@@ -41,24 +42,49 @@ void value_obj::Reset() {
     }
 }
 
-void buf_val::Resize(uint32_t size, bool cleanBuf) {
-    if ( size > Size() ) {
-        if (cleanBuf) {
-            reset();
-            mVal = static_cast<_ctx *>(
-                value_obj::Allocator()->Allocate( sizeof(uint32_t) + size )
-            );
-        } else {
-            _ctx * newVal = static_cast<_ctx *>(
-                value_obj::Allocator()->Allocate( sizeof(uint32_t) + size )
-            );
-            if (mVal) {
-                memcpy(newVal->mBuf, mVal->mBuf, mVal->mSize);
-                reset();
-            }
-            mVal = newVal;
-        }
+bool buf_val::reallocate(buf_size_t capacity, bool keepData) {
+    // The allocator only accepts 32-bit sizes.
+    buf_size_t ctxSize = offsetof(_ctx, mBuf) + capacity;
+    if ( ctxSize < capacity || ctxSize > 0xffffffff ) {
+        PDL_THROW( std::overflow_error("buf_val::Resize() overflow!") );
+        return false;
+    }
+    _ctx * newVal = static_cast<_ctx *>(
+        value_obj::Allocator()->Allocate( uint32_t(ctxSize) )
+    );
+    buf_size_t size = Size();
+    if (keepData && size)
+        memcpy( newVal->mBuf, Buf(), size ); // owned or attached.
+    reset();
+    mVal = newVal;
+    mVal->mSize = keepData? size: 0;
+    mVal->mCapacity = capacity;
+    mVal->mData = mVal->mBuf;
+    mVal->mReadOnly = false;
+    return true;
+}
+
+void buf_val::Resize(buf_size_t size, bool cleanBuf) {
+    if ( size > Capacity() ) {
+        const buf_size_t MAX_CAPACITY = 0xffffffff - offsetof(_ctx, mBuf);
+        buf_size_t capacity = Capacity();
+        capacity = (capacity > MAX_CAPACITY / 2)? MAX_CAPACITY: capacity * 2;
+        if (capacity < size)
+            capacity = size;
+        if ( !reallocate(capacity, !cleanBuf) )
+            return;
+    }
+    if (mVal)
+        mVal->mSize = size;
+}
+
+void buf_val::attach(uint8_t * data, buf_size_t size, bool readOnly) {
+    reset();
+    if ( data && reallocate(0, false) ) { // only the header.
         mVal->mSize = size;
+        mVal->mCapacity = size;
+        mVal->mData = data;
+        mVal->mReadOnly = readOnly;
     }
 }
 
@@ -114,6 +140,43 @@ int main(void) {
     strVal->Resize(10);
     strncpy(strVal->Str(), "'hello!'", 10);
     std::cout << "set value as " << strVal->Str() << std::endl;
+
+    const uint32_t RESIZE_COUNT = 100000;
+    buf_val bufVal;
+    uint32_t reallocCount = 0;
+    for (uint32_t i = 0; i < RESIZE_COUNT; ++i) {
+        const void * buf = bufVal.Buf();
+        bufVal.Resize(i + 1);
+        static_cast<uint8_t *>( bufVal.Buf() )[i] = uint8_t(i);
+        if ( bufVal.Buf() != buf )
+            ++reallocCount;
+    }
+    for (uint32_t i = 0; i < bufVal.Size(); ++i) {
+        if ( static_cast<const uint8_t *>( bufVal.Buf() )[i] != uint8_t(i) ) {
+            std::cout << "buf_val::Resize() lost data @" << i << std::endl;
+            return 1;
+        }
+    }
+    // The capacity grows geometrically, so the reallocations are no more than
+    // the bits of the size, plus the 1st. allocation.
+    uint32_t maxReallocCount = 1;
+    for (uint32_t n = RESIZE_COUNT; n; n >>= 1)
+        ++maxReallocCount;
+    if (reallocCount > maxReallocCount) {
+        std::cout << "buf_val::Resize() reallocated " << reallocCount << \
+            " times!" << std::endl;
+        return 1;
+    }
+    bufVal.Resize(10);
+    bufVal.Reserve(200000);
+    if ( bufVal.Size() != 10 || bufVal.Capacity() < 200000 ) {
+        std::cout << "buf_val::Reserve() failed: size " << bufVal.Size() << \
+            ", capacity " << bufVal.Capacity() << std::endl;
+        return 1;
+    }
+    std::cout << "resized buf_val " << RESIZE_COUNT << " times with " << \
+        reallocCount << " reallocations, size " << bufVal.Size() << \
+        ", capacity " << bufVal.Capacity() << std::endl;
     return 0;
 }
 
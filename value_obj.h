@@ -30,6 +30,13 @@ SOFTWARE. */
 
 namespace pdl {
 
+// The sizes of buf_val in byte, refer the bit_size_t in field_des.h.
+#ifdef ENABLE_64BIT_OFFSET
+typedef uint64_t buf_size_t;
+#else
+typedef uint32_t buf_size_t;
+#endif
+
 struct val_base {
     virtual const char * TypeName() const = 0;
     virtual ~val_base() {};
@@ -175,12 +182,20 @@ public:
 };
 
 class buf_val: public val_base {
+    // The attached external memory is referred by the header rather than the
+    // buf_val, so the size of buf_val (& the derived str_val etc.) is kept.
     struct _ctx {
-        uint32_t mSize;
+        buf_size_t mSize;
+        buf_size_t mCapacity;
+        uint8_t * mData; // 'mBuf' or the attached memory which is NOT owned.
+        bool mReadOnly; // the attached memory is read-only.
         uint8_t mBuf[1];
     };
     _ctx * mVal;
 
+    bool reallocate(buf_size_t capacity, bool keepData);
+    void attach(uint8_t * data, buf_size_t size, bool readOnly);
+
     void reset() {
         if (mVal) {
             value_obj::Allocator()->Recycle(mVal);
@@ -198,15 +213,50 @@ public:
     virtual ~buf_val() {
         reset();
     }
-    uint32_t Size() const {
+    buf_size_t Size() const {
         return mVal? mVal->mSize: 0;
     }
-    void Resize(uint32_t size, bool cleanBuf = false);
+    // The count of bytes which can be used without reallocation.
+    buf_size_t Capacity() const {
+        return mVal? mVal->mCapacity: 0;
+    }
+    // The capacity grows geometrically, so building a buffer by successive
+    // resizing costs amortized O(n); the data is discarded if 'cleanBuf' is
+    // true and the buffer is reallocated.
+    void Resize(buf_size_t size, bool cleanBuf = false);
+    void Reserve(buf_size_t capacity) {
+        if ( capacity > Capacity() )
+            reallocate(capacity, true);
+    }
     void * Buf() {
-        return mVal? mVal->mBuf: 0;
+        return mVal? mVal->mData: 0;
     }
     const void * Buf() const {
-        return mVal? mVal->mBuf: 0;
+        return mVal? mVal->mData: 0;
+    }
+    // Refers an external memory (e.g. a mmap'd file) without copy, the memory
+    // should be alive until it is detached, and it is copied into an owned
+    // buffer if Resize() needs to grow it.
+    void Attach(void * data, buf_size_t size) {
+        attach(static_cast<uint8_t *>(data), size, false);
+    }
+    // Refers a read-only memory (e.g. a PROT_READ mmap'd file) like the above
+    // one, but the buffer IsReadOnly(), so the writing by bit_ref (e.g. the
+    // encoding) fails; Buf() should NOT be written either.
+    void Attach(const void * data, buf_size_t size) {
+        attach(
+            static_cast<uint8_t *>( const_cast<void *>(data) ), size, true
+        );
+    }
+    bool IsAttached() const {
+        return mVal && mVal->mData != mVal->mBuf;
+    }
+    bool IsReadOnly() const {
+        return mVal && mVal->mReadOnly;
+    }
+    void Detach() {
+        if ( IsAttached() )
+            reset();
     }
 };
 
@@ -0,0 +1,418 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+#include "vlc_field.h"
+#include "bit_kernel.h"
+
+namespace pdl {
+
+// The ue(v) codes in 8 bits: (code size << 8) | value, or 0 for a longer code.
+static const uint16_t UE_CODE_TABLE[256] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    0x0707, 0x0707, 0x0708, 0x0708, 0x0709, 0x0709, 0x070a, 0x070a,
+    0x070b, 0x070b, 0x070c, 0x070c, 0x070d, 0x070d, 0x070e, 0x070e,
+    0x0503, 0x0503, 0x0503, 0x0503, 0x0503, 0x0503, 0x0503, 0x0503,
+    0x0504, 0x0504, 0x0504, 0x0504, 0x0504, 0x0504, 0x0504, 0x0504,
+    0x0505, 0x0505, 0x0505, 0x0505, 0x0505, 0x0505, 0x0505, 0x0505,
+    0x0506, 0x0506, 0x0506, 0x0506, 0x0506, 0x0506, 0x0506, 0x0506,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301, 0x0301,
+    0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302,
+    0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302,
+    0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302,
+    0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302, 0x0302,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100,
+    0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100, 0x0100
+};
+
+// Exp-Golomb code with up to 32 leading zeros, the value is 0 ~ 2^33 - 2.
+static bool decodeExpGolomb(bit_reader & reader, uint64_t * out_val) {
+    bit_size_t remained = reader.RemainedBits();
+    uint32_t code = UE_CODE_TABLE[ reader.Peek(8) ];
+    if (code) {
+        if ( (code >> 8) > remained )
+            return false;
+        reader.Skip(code >> 8);
+        *out_val = code & 0xff;
+        return true;
+    }
+    // The bits beyond the end are read as 0, so a truncated code is rejected
+    // by the size check.
+    uint64_t bits = reader.Peek(57);
+    if (0 == bits)
+        return false;
+    uint32_t leadingZeros = bit_kernel::CountLeadingZeros64(bits) - 7;
+    if ( leadingZeros > 32 || (leadingZeros << 1) + 1 > remained )
+        return false;
+    reader.Skip(leadingZeros);
+    *out_val = reader.Read(leadingZeros + 1) - 1;
+    return true;
+}
+
+static void encodeExpGolomb(bit_writer & writer, uint64_t val) {
+    ++val;
+    uint32_t leadingZeros = 63 - bit_kernel::CountLeadingZeros64(val);
+    writer.Write(leadingZeros, 0);
+    writer.Write(leadingZeros + 1, val);
+}
+
+bool ue_codec::Decode(bit_reader & reader, uint64_t * out_val) {
+    uint64_t val = 0;
+    if ( !decodeExpGolomb(reader, &val) || val > 0xffffffff )
+        return false;
+    *out_val = val;
+    return true;
+}
+
+bool ue_codec::Encode(bit_writer & writer, uint64_t val) {
+    if (val > 0xffffffff)
+        return false;
+    encodeExpGolomb(writer, val);
+    return true;
+}
+
+bool se_codec::Decode(bit_reader & reader, uint64_t * out_val) {
+    uint64_t code = 0;
+    if ( !decodeExpGolomb(reader, &code) )
+        return false;
+    uint64_t half = (code + 1) >> 1;
+    if ( half > ( (code & 1)? 0x7fffffff: 0x80000000 ) )
+        return false;
+    *out_val = static_cast<uint32_t>( (code & 1)? half: (0 - half) );
+    return true;
+}
+
+bool se_codec::Encode(bit_writer & writer, uint64_t val) {
+    int64_t sval = static_cast<int32_t>( static_cast<uint32_t>(val) );
+    encodeExpGolomb(
+        writer, (sval > 0)? uint64_t(sval << 1) - 1: uint64_t(-sval) << 1
+    );
+    return true;
+}
+
+bool leb128_codec::Decode(bit_reader & reader, uint64_t * out_val) {
+    enum code_size_value {
+        MAX_CODE_SIZE = 10
+    };
+    uint64_t val = 0;
+    uint32_t shift = 0;
+    // Decodes 7 bytes at most each time: the last byte is located by the 1st.
+    // byte without the continuation bit, then the 7-bit groups are packed by
+    // the masks instead of a loop.
+    for (uint32_t codeSize = 0; codeSize < MAX_CODE_SIZE; codeSize += 7) {
+        uint64_t block = reader.Peek(56);
+        uint64_t lastBytes = ~block & 0x0080808080808080ULL;
+        uint32_t n = lastBytes \
+            ? ( (bit_kernel::CountLeadingZeros64(lastBytes) - 8) >> 3 ) + 1: 7;
+        if ( codeSize + n > MAX_CODE_SIZE || (n << 3) > reader.RemainedBits() )
+            return false;
+        if ( MAX_CODE_SIZE == codeSize + n && \
+             ( ( block >> (56 - (n << 3)) ) & 0xff ) > 1 )
+            return false; // overflow.
+        // The 1st. byte is moved to the LSB, and the continuation bits and the
+        // bytes after the last one are cleared.
+        uint64_t groups = bit_kernel::ByteSwap64(block << 8) & \
+            ( ~uint64_t(0) >> ( 64 - (n << 3) ) ) & 0x7f7f7f7f7f7f7f7fULL;
+        groups = (groups & 0x007f007f007f007fULL) | \
+            ( (groups >> 1) & 0x3f803f803f803f80ULL );
+        groups = (groups & 0x00003fff00003fffULL) | \
+            ( (groups >> 2) & 0x0fffc0000fffc000ULL );
+        groups = (groups & 0x000000000fffffffULL) | \
+            ( (groups >> 4) & 0x00fffffff0000000ULL );
+        val |= groups << shift;
+        shift += n * 7;
+        reader.Skip(n << 3);
+        if (lastBytes) {
+            *out_val = val;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool leb128_codec::Encode(bit_writer & writer, uint64_t val) {
+    while (val > 0x7f) {
+        writer.Write( 8, 0x80 | (val & 0x7f) );
+        val >>= 7;
+    }
+    writer.Write(8, val);
+    return true;
+}
+
+bool zigzag_leb128_codec::Decode(bit_reader & reader, uint64_t * out_val) {
+    uint64_t code = 0;
+    if ( !leb128_codec::Decode(reader, &code) )
+        return false;
+    *out_val = (code >> 1) ^ ( 0 - (code & 1) );
+    return true;
+}
+
+bool zigzag_leb128_codec::Encode(bit_writer & writer, uint64_t val) {
+    uint64_t sign = (val >> 63)? ~uint64_t(0): 0;
+    return leb128_codec::Encode( writer, (val << 1) ^ sign );
+}
+
+// The code sizes (in bit) indexed by the 2-bit prefix.
+static const uint32_t QUIC_VARINT_SIZE[4] = {8, 16, 32, 64};
+
+bool quic_varint_codec::Decode(bit_reader & reader, uint64_t * out_val) {
+    if ( reader.RemainedBits() < 2 )
+        return false;
+    uint32_t codeSize = QUIC_VARINT_SIZE[ reader.Peek(2) ];
+    if ( codeSize > reader.RemainedBits() )
+        return false;
+    *out_val = reader.Read(codeSize) & ( ~uint64_t(0) >> (66 - codeSize) );
+    return true;
+}
+
+bool quic_varint_codec::Encode(bit_writer & writer, uint64_t val) {
+    for (uint64_t prefix = 0; prefix < 4; ++prefix) {
+        uint32_t codeSize = QUIC_VARINT_SIZE[prefix];
+        if ( 0 == ( val >> (codeSize - 2) ) ) {
+            writer.Write( codeSize, (prefix << (codeSize - 2)) | val );
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace pdl
+
+#ifdef VLC_FIELD_UT
+#include <iostream>
+#include <stdlib.h>
+
+using namespace pdl;
+
+template <typename C>
+static bool testCodes(
+    const char * name, const uint64_t * vals, uint32_t count)
+{
+    buf_val buf;
+    bit_writer writer(&buf, 3);
+    for (uint32_t i = 0; i < count; ++i) {
+        if ( !C::Encode(writer, vals[i]) ) {
+            std::cout << name << ": failed to encode " << vals[i] << std::endl;
+            return false;
+        }
+    }
+    bit_size_t end = writer.Offset();
+    writer.Flush();
+    bit_reader reader(bit_ref(&buf, 3));
+    for (uint32_t i = 0; i < count; ++i) {
+        uint64_t val = 0;
+        if ( !C::Decode(reader, &val) || val != vals[i] ) {
+            std::cout << name << ": failed to decode " << vals[i] << std::endl;
+            return false;
+        }
+    }
+    if ( reader.Offset() != end ) {
+        std::cout << name << ": wrong code size!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+template <typename C>
+static bool testBytes(
+    const char * name, uint64_t val, const uint8_t * code, uint32_t size)
+{
+    uint64_t decVal = 0;
+    bit_reader reader(code, size);
+    if ( !C::Decode(reader, &decVal) || decVal != val || \
+         reader.Offset() != (size << 3) )
+    {
+        std::cout << name << ": failed to decode " << val << std::endl;
+        return false;
+    }
+    // Truncated codes should be rejected.
+    bit_reader truncated(code, size - 1);
+    if ( C::Decode(truncated, &decVal) ) {
+        std::cout << name << ": truncated code accepted!" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+class ue_test_field: public ue_field {
+    virtual const char * FieldName() const {
+        return "ue_test";
+    }
+};
+
+// An array of 4 ue(v) codes in a message.
+class ue_array_field: public ue_test_field {
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 4;
+    }
+};
+
+class ue_msg_field: public combined_field_des {
+    virtual const char * FieldName() const {
+        return "ue_msg";
+    }
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 1;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return bitRef.MaxSize() - bitRef.Offset();
+    }
+};
+
+// Decodes the variable size items of the lazy view backwards and forwards.
+struct ue_range_callback: combined_field_des::parse_callback {
+    std::vector<uint64_t> mVals;
+
+    virtual int Callback(
+        const field_info_env & env, obj_ptr<field_info> & fieldInfo)
+    {
+        return 0;
+    }
+    virtual uint32_t LazyArrayThreshold() const {
+        return 1;
+    }
+    virtual int ArrayCallback(
+        const field_info_env & env, const field_info_range & range)
+    {
+        mVals.resize( range.Count() );
+        field_info_ctx item;
+        for (uint32_t i = range.Count(); i > 0; --i) {
+            range.ItemAt(i - 1, &item);
+            bit_reader reader( range.RefBits(env.mBuf, item) );
+            ue_codec::Decode(reader, &(mVals[i - 1]));
+            if (reader.Offset() != item.mFieldOffset + item.mFieldSize)
+                mVals[i - 1] = ~uint64_t(0);
+        }
+        return 0;
+    }
+};
+
+int main() {
+    uint64_t vals[256];
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t nbits = (i & 63) + 1;
+        vals[i] = ( (uint64_t(rand()) << 40) ^ (uint64_t(rand()) << 20) ^ \
+            rand() ) & ( ~uint64_t(0) >> (64 - nbits) );
+        if (i < 16)
+            vals[i] = i;
+    }
+    vals[16] = ~uint64_t(0);
+    vals[17] = uint64_t(1) << 63;
+
+    uint64_t vals32[256];
+    for (uint32_t i = 0; i < 256; ++i)
+        vals32[i] = vals[i] & 0xffffffff;
+    uint64_t vals62[256];
+    for (uint32_t i = 0; i < 256; ++i)
+        vals62[i] = vals[i] & ( ~uint64_t(0) >> 2 );
+
+    bool ok = testCodes<ue_codec>("ue", vals32, 256) && \
+        testCodes<se_codec>("se", vals32, 256) && \
+        testCodes<leb128_codec>("leb128", vals, 256) && \
+        testCodes<zigzag_leb128_codec>("zigzag_leb128", vals, 256) && \
+        testCodes<quic_varint_codec>("quic_varint", vals62, 256);
+
+    // The examples in the specifications.
+    const uint8_t leb128[] = {0xe5, 0x8e, 0x26};
+    const uint8_t zigzag[] = {0x03}; // -2
+    const uint8_t quic8[] = {0xc2, 0x19, 0x7c, 0x5e, 0xff, 0x14, 0xe8, 0x8c};
+    const uint8_t quic4[] = {0x9d, 0x7f, 0x3e, 0x7d};
+    const uint8_t quic2[] = {0x7b, 0xbd};
+    ok = ok && testBytes<leb128_codec>("leb128", 624485, leb128, 3) && \
+        testBytes<zigzag_leb128_codec>("zigzag_leb128", uint64_t(-2), zigzag, 1) && \
+        testBytes<quic_varint_codec>("quic_varint", 151288809941952652ULL, quic8, 8) && \
+        testBytes<quic_varint_codec>("quic_varint", 494878333, quic4, 4) && \
+        testBytes<quic_varint_codec>("quic_varint", 15293, quic2, 2);
+
+    // The field size and value through the field descriptor.
+    uint8_t code[] = {0x02, 0xd0}; // 0000001011010 -> 89
+    buf_val buf;
+    buf.Attach( code, sizeof(code) );
+    ue_test_field ueField;
+    value_obj val;
+    ok = ok && ueField.FieldSize(bit_ref(&buf, 0), 0, 0) == 13 && \
+        ueField.DecodeField(bit_ref(&buf, 0), &val) && \
+        val_itf_selector<int_val>::GetInterface(&val)->Val() == 89;
+
+    // Re-encoding in place: 88 has the same code size, but 1 doesn't.
+    val_itf_selector<int_val>::GetInterface(&val)->Val() = 88;
+    ok = ok && ueField.EncodeField(bit_ref(&buf, 0), &val) && \
+        code[0] == 0x02 && code[1] == 0xc8;
+    val_itf_selector<int_val>::GetInterface(&val)->Val() = 1;
+    ok = ok && !ueField.EncodeField(bit_ref(&buf, 0), &val) && \
+        code[0] == 0x02 && code[1] == 0xc8;
+
+    // The lazy view of the ue(v) array.
+    uint8_t codes[] = {0xa6, 0x42, 0x80}; // 1 010 011 00100: 0 ~ 3
+    buf_val codesBuf;
+    codesBuf.Attach( codes, sizeof(codes) );
+    ue_msg_field msgField;
+    ue_array_field arrayField;
+    field_des_tree::node_ptr msgNode = field_des_tree::CreateNode(&msgField);
+    msgField.BindTreeNode(msgNode);
+    msgNode->SetSubNodeCapacity(1);
+    field_des_tree::node_ptr arrayNode = \
+        field_des_tree::CreateNode(&arrayField);
+    arrayField.BindTreeNode(arrayNode);
+    msgNode->SetSubNode(0, arrayNode);
+    field_des_tree msgTree(msgNode); // to delete nodes.
+    field_des_dependency msgFieldDesDep;
+    field_info_env msgEnv = {&msgFieldDesDep, &codesBuf};
+    ue_range_callback rangeCb;
+    msgField.ParseField(&rangeCb, msgEnv);
+    ok = ok && rangeCb.mVals.size() == 4 && rangeCb.mVals[0] == 0 && \
+        rangeCb.mVals[1] == 1 && rangeCb.mVals[2] == 2 && \
+        rangeCb.mVals[3] == 3;
+
+    std::cout << (ok? "vlc_field test passed.": "vlc_field test failed!") << \
+        std::endl;
+    return ok? 0: 1;
+}
+#endif // VLC_FIELD_UT
@@ -0,0 +1,162 @@
+/* Copyright (c) 2016 Qing Li
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+
+#ifndef _VLC_FIELD_H_
+#define _VLC_FIELD_H_
+
+#ifndef __cplusplus
+#error The module is NOT compatible with C codes.
+#endif
+
+#include "field_des.h"
+
+namespace pdl {
+
+// The codecs of the variable-length codes, Decode() returns false if the code
+// is invalid or truncated (the reader position is undefined in that case), and
+// Encode() returns false if the value is out of the range of the code.
+//   data_type: the type of the decoded value which is stored in val_type.
+
+// ue(v) Exp-Golomb code, the value is 0 ~ 0xffffffff.
+struct ue_codec {
+    typedef uint32_t data_type;
+    typedef int_val val_type;
+
+    static bool Decode(bit_reader & reader, uint64_t * out_val);
+    static bool Encode(bit_writer & writer, uint64_t val);
+};
+
+// se(v) Exp-Golomb code, the value is a 32-bit signed integer.
+struct se_codec {
+    typedef uint32_t data_type;
+    typedef int_val val_type;
+
+    static bool Decode(bit_reader & reader, uint64_t * out_val);
+    static bool Encode(bit_writer & writer, uint64_t val);
+};
+
+// Unsigned LEB128 code (up to 10 bytes), the value is 64-bit unsigned.
+struct leb128_codec {
+    typedef uint64_t data_type;
+    typedef int64_val val_type;
+
+    static bool Decode(bit_reader & reader, uint64_t * out_val);
+    static bool Encode(bit_writer & writer, uint64_t val);
+};
+
+// Zigzag LEB128 code, the value is 64-bit signed.
+struct zigzag_leb128_codec {
+    typedef uint64_t data_type;
+    typedef int64_val val_type;
+
+    static bool Decode(bit_reader & reader, uint64_t * out_val);
+    static bool Encode(bit_writer & writer, uint64_t val);
+};
+
+// QUIC variable-length integer (RFC 9000), the value is 0 ~ 2^62 - 1.
+struct quic_varint_codec {
+    typedef uint64_t data_type;
+    typedef int64_val val_type;
+
+    static bool Decode(bit_reader & reader, uint64_t * out_val);
+    static bool Encode(bit_writer & writer, uint64_t val);
+};
+
+// The leaf field of a variable-length code, the field size is decided by the
+// code itself. The derived class should implement FieldName(), and may
+// override FieldCount() for an array of codes.
+// NOTE: EncodeField() overwrites the bits in place, so it fails (and keeps the
+// old code) if the new code has another size.
+template <typename C>
+class vlc_field: public leaf_field_des {
+public:
+    typedef C codec_type;
+    typedef typename C::data_type data_type;
+    typedef typename C::val_type val_type;
+
+    virtual uint32_t FieldCount(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        return 1;
+    }
+    virtual bit_size_t FieldSize(
+        bit_ref bitRef,
+        const field_info_ctx * depFieldInfo,
+        uint32_t depFieldInfoCount) const
+    {
+        bit_reader reader(bitRef);
+        uint64_t data = 0;
+        return codec_type::Decode(reader, &data) \
+            ? reader.Offset() - bitRef.Offset(): 0;
+    }
+    virtual bool DecodeField(bit_ref bitRef, value_obj * out_val) const {
+        if (out_val) {
+            bit_reader reader(bitRef);
+            uint64_t data = 0;
+            if ( codec_type::Decode(reader, &data) ) {
+                out_val->Reset();
+                val_itf_selector<val_type>::GetInterface(out_val)->Val() = \
+                    static_cast<data_type>(data);
+                return true;
+            }
+        }
+        return false;
+    }
+    virtual bool DecodeInt(bit_ref bitRef, uint64_t * out_val) const {
+        bit_reader reader(bitRef);
+        uint64_t data = 0;
+        if ( out_val && codec_type::Decode(reader, &data) ) {
+            *out_val = static_cast<data_type>(data);
+            return true;
+        }
+        return false;
+    }
+    virtual bool EncodeField(bit_ref bitRef, const value_obj * val) const {
+        const val_type * itf = val_itf_selector<val_type>::GetInterface(val);
+        if ( itf && bitRef.IsWritable() ) {
+            // Encodes to a scratch buffer 1st., to keep the old code if the
+            // size differs.
+            buf_val code;
+            bit_size_t codeSize = 0;
+            {
+                bit_writer writer(&code);
+                if ( !codec_type::Encode( writer, itf->Val() ) )
+                    return false;
+                codeSize = writer.Offset();
+            }
+            return codeSize == FieldSize(bitRef, 0, 0) && \
+                bitRef.ImportBits(codeSize, &code) == codeSize;
+        }
+        return false;
+    }
+};
+
+typedef vlc_field<ue_codec> ue_field;
+typedef vlc_field<se_codec> se_field;
+typedef vlc_field<leb128_codec> leb128_field;
+typedef vlc_field<zigzag_leb128_codec> zigzag_leb128_field;
+typedef vlc_field<quic_varint_codec> quic_varint_field;
+
+} // namespace pdl
+
+#endif // _VLC_FIELD_H_